@@ -0,0 +1,788 @@
+/* Benchmarks of each phase of Polylla
+    The inputs are synthetic triangulations (synthetic_mesh.hpp) of 10^3 to 10^7 triangles, uniform and
+    anisotropic. The travel and the reparation are also measured in meshes with many barrier-edge tips (kind:2).
+    The meshes are written in the temporary directory the first time they are used.
+    Each benchmark only measures its phase, the previous phases are done before the timed loop.
+    The travel and reparation benchmarks also report the heap allocations per iteration, counted by the
+    replacement of the global operator new of this file.
+    The Delaunay benchmark triangulates random points and the points of a grid, whose cocircular points are
+    decided by the exact predicates.
+    The longest-edge benchmarks compare the predicate of predicates.hpp with the sqrt comparison it replaced and
+    with the exact comparison without filter, in the triangles of the meshes and in near-isosceles triangles.
+    The adjacency benchmark builds the polygon adjacency of a complete mesh.
+    Travel_Output compares the travel followed by the writers with the streaming mode (polygon_stream.hpp).
+    The backend benchmarks compare Triangulation, CompactTriangulation and CompressTriangulation: the construction
+    and the bytes per triangle (Backend_Memory) and a full rotation around each vertex (Backend_Traversal).
+
+    ./polylla_benchmark --benchmark_filter=Travel/triangles:1000000
+*/
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <unordered_map>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <benchmark/benchmark.h>
+#include <triangulation.hpp>
+#include <compact_triangulation.hpp>
+#include <compresshalfedge.hpp>
+#include <polylla.hpp>
+#include <predicates.hpp>
+#include <mesh_reader.hpp>
+#include <twin_matching.hpp>
+#include <delaunay.hpp>
+#include "synthetic_mesh.hpp"
+
+//Number of calls to operator new since the program started
+static std::atomic<std::size_t> n_allocations(0);
+
+void *operator new(std::size_t size){
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+//Discard the messages written in std::cout while it is alive, the constructors print their progress
+struct quiet_cout {
+    std::ostringstream sink;
+    std::streambuf *old;
+    quiet_cout() : old(std::cout.rdbuf(sink.rdbuf())) {}
+    ~quiet_cout() { std::cout.rdbuf(old); }
+};
+
+//Triangulation whose construction steps can be called one by one
+class triangulation_steps : public Triangulation
+{
+public:
+    using Triangulation::read_nodes_from_file;
+    using Triangulation::read_triangles_from_file;
+    using Triangulation::read_neigh_from_file;
+    using Triangulation::read_OFFfile;
+    using Triangulation::construct_interior_halfEdges_from_faces_and_neighs;
+    using Triangulation::construct_interior_halfEdges_from_faces;
+    using Triangulation::construct_exterior_halfEdges;
+
+    //Remove the halfedges, or set them to a copy saved before
+    void set_halfedges(const mesh_array<halfEdge> &halfedges){
+        HalfEdges = halfedges;
+        n_halfedges = halfedges.size();
+    }
+
+    const mesh_array<halfEdge> &get_halfedges() { return HalfEdges; }
+};
+
+//Polylla mesh whose phases can be called one by one
+class polylla_steps : public Polylla
+{
+public:
+    using Polylla::label_max_edges;
+    using Polylla::label_frontier_edges;
+    using Polylla::label_seed_edges;
+    using Polylla::travel_phase;
+    using Polylla::travel_triangles;
+    using Polylla::has_BarrierEdgeTip;
+    using Polylla::barrieredge_tip_reparation;
+    using Polylla::travel_buffers;
+
+    //Generate the triangulation of the files and the empty labels, no phase is done
+    polylla_steps(const std::string &prefix){
+        quiet_cout quiet;
+        tr = new Triangulation(prefix + ".node", prefix + ".ele", prefix + ".neigh");
+        max_edges = bit_vector(tr->halfEdges(), false);
+        frontier_edges = bit_vector(tr->halfEdges(), false);
+        terminal_edges = bit_vector(tr->halfEdges(), false);
+    }
+
+    //Do every phase to have a complete mesh
+    void construct(){
+        quiet_cout quiet;
+        construct_Polylla();
+    }
+
+    bit_vector &get_frontier_edges() { return frontier_edges; }
+    std::vector<int> &get_seed_edges() { return seed_edges; }
+    std::size_t n_polygons() { return polygonal_mesh.size(); }
+    Triangulation &get_triangulation() { return *tr; }
+    int get_barrier_edge_tips() { return n_barrier_edge_tips; }
+
+    //Travel the seed edges and write the .off and .ale files while the polygons are generated
+    void stream_travel(polygon_stream &out){
+        quiet_cout quiet;
+        stream = &out;
+        stream_vertices();
+        stream_travel_phase();
+        stream_end();
+        stream = nullptr;
+    }
+
+    //Build the polygon adjacency again, the adjacency built before is discarded
+    std::size_t rebuild_adjacency(){
+        quiet_cout quiet;
+        adjacency_offsets.clear();
+        build_polygon_adjacency();
+        return adjacency.size();
+    }
+
+    //Remove the polygons generated by the travel phase, the frontier edges are set to a copy saved before it
+    void reset_travel(const bit_vector &frontier){
+        frontier_edges = frontier;
+        polygonal_mesh.clear();
+        n_barrier_edge_tips = 0;
+    }
+};
+
+static std::string mesh_files(const benchmark::State &state){
+    return synthetic_mesh::files(state.range(0), (synthetic_mesh::kind)state.range(1));
+}
+
+static std::size_t file_size(const std::string &name){
+    return std::filesystem::file_size(name);
+}
+
+static void set_triangles(benchmark::State &state, std::size_t n_triangles){
+    state.SetItemsProcessed(state.iterations()*n_triangles);
+    state.counters["triangles"] = n_triangles;
+}
+
+//Parsing of the .node, .ele and .neigh files
+static void Parse_NodeEleNeigh(benchmark::State &state){
+    std::string prefix = mesh_files(state);
+    std::vector<double> points;
+    std::vector<char> border;
+    std::vector<int> faces, neighs;
+    for(auto _ : state){
+        mesh_reader::read_node_file(prefix + ".node", points, border);
+        mesh_reader::read_ele_file(prefix + ".ele", faces);
+        mesh_reader::read_neigh_file(prefix + ".neigh", neighs);
+        benchmark::DoNotOptimize(neighs.data());
+    }
+    state.SetBytesProcessed(state.iterations()*(file_size(prefix + ".node") + file_size(prefix + ".ele") + file_size(prefix + ".neigh")));
+    set_triangles(state, faces.size()/3);
+}
+
+//Parsing of the OFF file
+static void Parse_OFF(benchmark::State &state){
+    std::string prefix = mesh_files(state);
+    std::vector<double> points;
+    std::vector<int> faces;
+    for(auto _ : state){
+        mesh_reader::read_off_file(prefix + ".off", points, faces);
+        benchmark::DoNotOptimize(faces.data());
+    }
+    state.SetBytesProcessed(state.iterations()*file_size(prefix + ".off"));
+    set_triangles(state, faces.size()/3);
+}
+
+//Interior halfedges from the triangles and their neighbors
+static void InteriorHalfEdges_Neighs(benchmark::State &state){
+    std::string prefix = mesh_files(state);
+    triangulation_steps tr;
+    tr.read_nodes_from_file(prefix + ".node", 1);
+    std::vector<int> faces = tr.read_triangles_from_file(prefix + ".ele", 1);
+    std::vector<int> neighs = tr.read_neigh_from_file(prefix + ".neigh", 1);
+    mesh_array<halfEdge> empty;
+    for(auto _ : state){
+        state.PauseTiming();
+        tr.set_halfedges(empty);
+        state.ResumeTiming();
+        tr.construct_interior_halfEdges_from_faces_and_neighs(faces, neighs);
+    }
+    set_triangles(state, tr.faces());
+}
+
+//Interior halfedges from the triangles, the twins are searched (OFF input)
+static void InteriorHalfEdges_Faces(benchmark::State &state){
+    std::string prefix = mesh_files(state);
+    triangulation_steps tr;
+    std::vector<int> faces = tr.read_OFFfile(prefix + ".off", 1);
+    mesh_array<halfEdge> empty;
+    for(auto _ : state){
+        state.PauseTiming();
+        tr.set_halfedges(empty);
+        state.ResumeTiming();
+        tr.construct_interior_halfEdges_from_faces(faces, 1);
+    }
+    set_triangles(state, tr.faces());
+}
+
+//Twin matching with the hash map used before twin_matching.hpp, hash(a) ^ hash(b) of the pair of vertices
+//Only used as reference for TwinMatching_RadixSort
+static std::vector<int> match_twins_with_map(const std::vector<int> &faces){
+    auto hash_for_pair = [](const std::pair<int, int>& p) {
+        return std::hash<int>{}(p.first) ^ std::hash<int>{}(p.second);
+    };
+    std::unordered_map<std::pair<int, int>, int, decltype(hash_for_pair)> map_edges(3*faces.size(), hash_for_pair);
+    for(std::size_t e = 0; e < faces.size(); e++)
+        map_edges[std::make_pair(faces[e], faces[3*(e/3) + (e+1)%3])] = e;
+    std::vector<int> twins(faces.size(), -1);
+    for(std::size_t e = 0; e < faces.size(); e++){
+        auto it = map_edges.find(std::make_pair(faces[3*(e/3) + (e+1)%3], faces[e]));
+        if(it != map_edges.end())
+            twins[e] = it->second;
+    }
+    return twins;
+}
+
+static void TwinMatching_Map(benchmark::State &state){
+    std::vector<double> points;
+    std::vector<int> faces;
+    mesh_reader::read_off_file(mesh_files(state) + ".off", points, faces);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(match_twins_with_map(faces).data());
+    set_triangles(state, faces.size()/3);
+}
+
+//Twin matching by radix sort, the third argument is the number of threads
+static void TwinMatching_RadixSort(benchmark::State &state){
+    std::vector<double> points;
+    std::vector<int> faces;
+    mesh_reader::read_off_file(mesh_files(state) + ".off", points, faces);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(match_twins(faces, points.size()/2, state.range(2)).twins.data());
+    set_triangles(state, faces.size()/3);
+}
+
+//Exterior halfedges linked along the boundary
+static void ExteriorHalfEdges(benchmark::State &state){
+    std::string prefix = mesh_files(state);
+    triangulation_steps tr;
+    tr.read_nodes_from_file(prefix + ".node", 1);
+    std::vector<int> faces = tr.read_triangles_from_file(prefix + ".ele", 1);
+    std::vector<int> neighs = tr.read_neigh_from_file(prefix + ".neigh", 1);
+    tr.construct_interior_halfEdges_from_faces_and_neighs(faces, neighs);
+    mesh_array<halfEdge> interior = tr.get_halfedges();
+    for(auto _ : state){
+        state.PauseTiming();
+        tr.set_halfedges(interior);
+        state.ResumeTiming();
+        tr.construct_exterior_halfEdges();
+    }
+    set_triangles(state, tr.faces());
+}
+
+//Delaunay triangulation of state.range(0) points, uniform random or a grid if state.range(1) is 1,
+//with state.range(2) threads
+static void Delaunay(benchmark::State &state){
+    std::size_t n = state.range(0);
+    std::vector<double> input(2*n);
+    std::mt19937_64 rng(n);
+    std::uniform_real_distribution<double> coordinate(0, 10000);
+    std::size_t side = std::sqrt((double)n);
+    for(std::size_t i = 0; i < n; i++){
+        input[2*i] = state.range(1) ? i%side : coordinate(rng);
+        input[2*i+1] = state.range(1) ? i/side : coordinate(rng);
+    }
+    std::vector<double> points;
+    std::vector<int> faces, neighs;
+    std::vector<char> border;
+    for(auto _ : state){
+        points = input;
+        delaunay::triangulate(points, faces, neighs, border, state.range(2));
+        benchmark::DoNotOptimize(neighs.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+    state.counters["triangles"] = faces.size()/3;
+}
+
+static void Label_MaxEdges(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    for(auto _ : state)
+        mesh.label_max_edges();
+    set_triangles(state, state.range(0));
+}
+
+//Comparisons of the longest edge of a triangle, the coordinates of the triangle are x0 y0 x1 y1 x2 y2
+enum longest_edge_method { NAIVE, FILTERED, EXACT };
+
+//Comparison of the lengths with sqrt of the label phase before predicates.hpp
+static int longest_edge_naive(const double *p){
+    double dist0 = sqrt(pow(p[0] - p[2], 2) + pow(p[1] - p[3], 2));
+    double dist1 = sqrt(pow(p[2] - p[4], 2) + pow(p[3] - p[5], 2));
+    double dist2 = sqrt(pow(p[4] - p[0], 2) + pow(p[5] - p[1], 2));
+    if((dist0 >= dist1 && dist1 >= dist2) || (dist0 >= dist2 && dist2 >= dist1))
+        return 0;
+    if((dist1 >= dist0 && dist0 >= dist2) || (dist1 >= dist2 && dist2 >= dist0))
+        return 1;
+    return 2;
+}
+
+//Exact comparison of every pair of edges, without the filter
+static int longest_edge_exact(const double *p){
+    int c01 = predicates::compare_lengths_exact(p[0], p[1], p[2], p[3], p[2], p[3], p[4], p[5]);
+    int c12 = predicates::compare_lengths_exact(p[2], p[3], p[4], p[5], p[4], p[5], p[0], p[1]);
+    int c20 = predicates::compare_lengths_exact(p[4], p[5], p[0], p[1], p[0], p[1], p[2], p[3]);
+    if(c01 >= 0 && c20 <= 0)
+        return 0;
+    if(c12 >= 0)
+        return 1;
+    return 2;
+}
+
+static int longest_edge(int method, const double *p){
+    if(method == NAIVE)
+        return longest_edge_naive(p);
+    if(method == FILTERED)
+        return predicates::longest_edge(p[0], p[1], p[2], p[3], p[4], p[5]);
+    return longest_edge_exact(p);
+}
+
+//Longest edge of each triangle of the mesh with the method state.range(2), the triangles are copied to an array
+//so only the predicate is measured. The counter wrong is the number of triangles labeled different than EXACT
+static void LongestEdge_Mesh(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    Triangulation &tr = mesh.get_triangulation();
+    std::vector<double> points(6*tr.faces());
+    for(int f = 0; f < tr.faces(); f++){
+        int e = tr.edge_of_face(f);
+        for(int k = 0; k < 3; k++, e = tr.next(e)){
+            points[6*f + 2*k] = tr.get_PointX(tr.origin(e));
+            points[6*f + 2*k + 1] = tr.get_PointY(tr.origin(e));
+        }
+    }
+    int method = state.range(2);
+    for(auto _ : state){
+        int sum = 0;
+        for(std::size_t f = 0; f < points.size(); f += 6)
+            sum += longest_edge(method, &points[f]);
+        benchmark::DoNotOptimize(sum);
+    }
+    std::size_t wrong = 0;
+    for(std::size_t f = 0; f < points.size(); f += 6)
+        wrong += longest_edge(method, &points[f]) != longest_edge_exact(&points[f]);
+    state.counters["wrong"] = wrong;
+    set_triangles(state, tr.faces());
+}
+
+//Near-isosceles triangles of the size of their distance to the origin: the base is (x - w, y), (x + w, y) and the
+//apex is moved from x by -4 to 4 ulps, so the two sides differ by about one ulp of their length or are equal
+//Output: coordinates x0 y0 x1 y1 x2 y2 of each triangle
+static std::vector<double> near_isosceles_triangles(std::size_t n){
+    std::mt19937_64 rng(n);
+    std::uniform_real_distribution<double> position(1e5, 1e6), size(0.25, 1);
+    std::uniform_int_distribution<int> ulps(-4, 4);
+    std::vector<double> points(6*n);
+    for(std::size_t t = 0; t < n; t++){
+        double x = position(rng), y = position(rng), w = x*size(rng), h = x*size(rng), apex = x;
+        for(int u = ulps(rng); u != 0; u += u > 0 ? -1 : 1)
+            apex = std::nextafter(apex, u > 0 ? INFINITY : -INFINITY);
+        double p[6] = {x - w, y, x + w, y, apex, y + h};
+        //the longest edge is one of the sides, rotate the vertices so it can be any edge
+        int r = t % 3;
+        for(int k = 0; k < 3; k++){
+            points[6*t + 2*k] = p[2*((k + r) % 3)];
+            points[6*t + 2*k + 1] = p[2*((k + r) % 3) + 1];
+        }
+    }
+    return points;
+}
+
+static void LongestEdge_NearIsosceles(benchmark::State &state){
+    std::size_t n = state.range(0);
+    std::vector<double> points = near_isosceles_triangles(n);
+    int method = state.range(1);
+    for(auto _ : state){
+        int sum = 0;
+        for(std::size_t t = 0; t < points.size(); t += 6)
+            sum += longest_edge(method, &points[t]);
+        benchmark::DoNotOptimize(sum);
+    }
+    std::size_t wrong = 0;
+    for(std::size_t t = 0; t < points.size(); t += 6)
+        wrong += longest_edge(method, &points[t]) != longest_edge_exact(&points[t]);
+    state.counters["wrong"] = wrong;
+    set_triangles(state, n);
+}
+
+//Longest edges of the triangles corners[0][t] corners[1][t] corners[2][t] with the kernel of max_edge_kernel.hpp of
+//the instructions level, the instructions not supported by the processor are skipped
+//The counter wrong is the number of triangles whose result differs from the scalar kernel
+static void run_max_edge_kernel(benchmark::State &state, max_edge_kernel::isa level,
+    const max_edge_kernel::point_arrays &points, const std::vector<int> corners[3]){
+    if(level > max_edge_kernel::selected_isa()){
+        state.SkipWithError("instructions not supported by the processor");
+        return;
+    }
+    std::size_t n = corners[0].size();
+    std::vector<unsigned char> max(n), scalar(n);
+    for(auto _ : state){
+        max_edge_kernel::longest_edges(level, points, corners[0].data(), corners[1].data(), corners[2].data(), n, max.data());
+        benchmark::DoNotOptimize(max.data());
+    }
+    max_edge_kernel::longest_edges_scalar(points, corners[0].data(), corners[1].data(), corners[2].data(), n, scalar.data());
+    std::size_t wrong = 0;
+    for(std::size_t t = 0; t < n; t++)
+        wrong += max[t] != scalar[t];
+    state.counters["wrong"] = wrong;
+    state.SetLabel(max_edge_kernel::isa_name(level));
+    set_triangles(state, n);
+}
+
+//Kernel on the triangles of the mesh, with the coordinates in the array of structs of Triangulation
+static void MaxEdgeKernel_Mesh(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    Triangulation &tr = mesh.get_triangulation();
+    std::vector<int> corners[3];
+    for(int f = 0; f < tr.faces(); f++){
+        int e = tr.edge_of_face(f);
+        for(int k = 0; k < 3; k++, e = tr.next(e))
+            corners[k].push_back(tr.origin(e));
+    }
+    run_max_edge_kernel(state, (max_edge_kernel::isa)state.range(2), tr.get_point_arrays(), corners);
+}
+
+//Kernel on near-isosceles triangles, with the coordinates in two arrays, most triangles use the exact predicate
+static void MaxEdgeKernel_NearIsosceles(benchmark::State &state){
+    std::size_t n = state.range(0);
+    std::vector<double> points = near_isosceles_triangles(n), x(3*n), y(3*n);
+    std::vector<int> corners[3];
+    for(std::size_t v = 0; v < 3*n; v++){
+        x[v] = points[2*v];
+        y[v] = points[2*v + 1];
+        corners[v % 3].push_back(v);
+    }
+    max_edge_kernel::point_arrays arrays;
+    arrays.x = x.data();
+    arrays.y = y.data();
+    run_max_edge_kernel(state, (max_edge_kernel::isa)state.range(1), arrays, corners);
+}
+
+static void Label_FrontierEdges(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.label_max_edges();
+    for(auto _ : state)
+        mesh.label_frontier_edges();
+    set_triangles(state, state.range(0));
+}
+
+static void Label_SeedEdges(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.label_max_edges();
+    mesh.label_frontier_edges();
+    for(auto _ : state)
+        mesh.label_seed_edges();
+    state.counters["seeds"] = mesh.get_seed_edges().size();
+    set_triangles(state, state.range(0));
+}
+
+//Travel phase, including the reparation of the polygons with barrier-edge tips
+static void Travel(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.label_max_edges();
+    mesh.label_frontier_edges();
+    mesh.label_seed_edges();
+    std::vector<char> frontier = mesh.get_frontier_edges();
+    std::size_t allocations = 0;
+    for(auto _ : state){
+        state.PauseTiming();
+        mesh.reset_travel(frontier);
+        state.ResumeTiming();
+        std::size_t before = n_allocations;
+        mesh.travel_phase();
+        allocations = n_allocations - before;
+    }
+    state.counters["allocations"] = allocations; //allocations of the last iteration
+    state.counters["polygons"] = mesh.n_polygons();
+    state.counters["barrier_edge_tips"] = mesh.get_barrier_edge_tips();
+    set_triangles(state, state.range(0));
+}
+
+//Reparation of the polygons with barrier-edge tips, the polygons are traveled before the timed loop
+//items_per_second is the number of barrier-edge tips repaired per second
+static void Reparation(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.label_max_edges();
+    mesh.label_frontier_edges();
+    mesh.label_seed_edges();
+    std::vector<std::pair<int, std::vector<int>>> non_simple;
+    std::vector<int> poly;
+    for(int e : mesh.get_seed_edges()){
+        mesh.travel_triangles(e, poly);
+        if(mesh.has_BarrierEdgeTip(poly))
+            non_simple.push_back({e, poly});
+    }
+    std::vector<char> frontier = mesh.get_frontier_edges();
+    polylla_steps::travel_buffers buffer;
+    int n_bet = 0;
+    std::size_t allocations = 0;
+    for(auto _ : state){
+        state.PauseTiming();
+        mesh.reset_travel(frontier);
+        buffer.polygons.clear();
+        n_bet = 0;
+        state.ResumeTiming();
+        std::size_t before = n_allocations;
+        for(auto &p : non_simple)
+            n_bet += mesh.barrieredge_tip_reparation(p.first, p.second, buffer);
+        allocations = n_allocations - before;
+    }
+    state.SetItemsProcessed(state.iterations()*n_bet);
+    state.counters["allocations"] = allocations; //allocations of the last iteration
+    state.counters["non_simple_polygons"] = non_simple.size();
+    state.counters["barrier_edge_tips"] = n_bet;
+    state.counters["triangles"] = state.range(0);
+}
+
+//Local update after moving 1000 interior vertices, each iteration moves them back or forth by 1% of a cell
+static void MoveVertices(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.construct();
+    Triangulation &tr = mesh.get_triangulation();
+    double delta = state.range(1) == synthetic_mesh::ANISOTROPIC ? 1e-5 : 1e-2;
+    std::mt19937_64 rng(state.range(0));
+    std::uniform_int_distribution<int> pick(0, tr.vertices() - 1);
+    std::vector<int> vertices;
+    std::vector<char> picked(tr.vertices(), false);
+    while(vertices.size() < 1000 && vertices.size() + 100 < tr.vertices()){
+        int v = pick(rng);
+        if(!picked[v] && !tr.is_border_vertex(v)){
+            picked[v] = true;
+            vertices.push_back(v);
+        }
+    }
+    std::vector<double> x[2], y[2];
+    for(int v : vertices){
+        x[0].push_back(tr.get_PointX(v));
+        y[0].push_back(tr.get_PointY(v));
+        x[1].push_back(tr.get_PointX(v) + delta);
+        y[1].push_back(tr.get_PointY(v) + delta);
+    }
+    mesh.move_vertices(vertices, x[0], y[0]); //the first update builds the polygon of each face
+    int side = 0;
+    for(auto _ : state){
+        side = 1 - side;
+        mesh.move_vertices(vertices, x[side], y[side]);
+    }
+    state.SetItemsProcessed(state.iterations()*vertices.size());
+    state.counters["moved_vertices"] = vertices.size();
+    state.counters["triangles"] = state.range(0);
+}
+
+//Insertion of 1000 constrained edges, each iteration inserts edges that are not constrained yet
+//when every interior edge is constrained the mesh is generated again out of the timing
+static void AddConstrainedEdges(benchmark::State &state){
+    std::string prefix = mesh_files(state);
+    auto mesh = std::make_unique<polylla_steps>(prefix);
+    mesh->construct();
+    Triangulation &tr = mesh->get_triangulation();
+    std::vector<int> edges;
+    for(int e = 0; e < tr.halfEdges(); e++)
+        if(tr.is_interior_face(e) && tr.is_interior_face(tr.twin(e)) && e < tr.twin(e))
+            edges.push_back(e);
+    std::shuffle(edges.begin(), edges.end(), std::mt19937_64(state.range(0)));
+    mesh->add_constrained_edges({}); //the first update builds the polygon of each face
+    std::size_t next = 0;
+    std::vector<int> batch;
+    for(auto _ : state){
+        if(next + 1000 > edges.size()){
+            state.PauseTiming();
+            mesh = std::make_unique<polylla_steps>(prefix);
+            mesh->construct();
+            mesh->add_constrained_edges({});
+            next = 0;
+            state.ResumeTiming();
+        }
+        batch.assign(edges.begin() + next, edges.begin() + std::min(next + 1000, edges.size()));
+        next += batch.size();
+        mesh->add_constrained_edges(batch);
+    }
+    state.SetItemsProcessed(state.iterations()*1000);
+    state.counters["triangles"] = state.range(0);
+}
+
+//Polygon adjacency of a complete mesh, items_per_second is the number of triangles per second
+static void Adjacency(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.construct();
+    std::size_t adjacencies = 0;
+    for(auto _ : state)
+        adjacencies = mesh.rebuild_adjacency();
+    state.counters["polygons"] = mesh.n_polygons();
+    state.counters["adjacencies"] = adjacencies;
+    set_triangles(state, state.range(0));
+}
+
+//Travel phase and writing of the .off and .ale files, after the travel (stream:0) or while the polygons are
+//generated (stream:1), the labels are done before the timed loop
+static void Travel_Output(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.label_max_edges();
+    mesh.label_frontier_edges();
+    mesh.label_seed_edges();
+    std::vector<char> frontier = mesh.get_frontier_edges();
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "polylla_benchmark";
+    std::string off = (dir / "output.off").string(), ale = (dir / "output.ale").string();
+    for(auto _ : state){
+        state.PauseTiming();
+        mesh.reset_travel(frontier);
+        state.ResumeTiming();
+        if(state.range(2)){
+            polygon_stream out(off, ale, 4);
+            mesh.stream_travel(out);
+        }else{
+            mesh.travel_phase();
+            mesh.print_OFF(off);
+            mesh.print_ALE(ale);
+        }
+    }
+    state.SetBytesProcessed(state.iterations()*(file_size(off) + file_size(ale)));
+    set_triangles(state, state.range(0));
+}
+
+static void Output_OFF(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.construct();
+    std::string output = (std::filesystem::temp_directory_path() / "polylla_benchmark" / "output.off").string();
+    for(auto _ : state)
+        mesh.print_OFF(output);
+    state.SetBytesProcessed(state.iterations()*file_size(output));
+    set_triangles(state, state.range(0));
+}
+
+static void Output_ALE(benchmark::State &state){
+    polylla_steps mesh(mesh_files(state));
+    mesh.construct();
+    std::string output = (std::filesystem::temp_directory_path() / "polylla_benchmark" / "output.ale").string();
+    for(auto _ : state)
+        mesh.print_ALE(output);
+    state.SetBytesProcessed(state.iterations()*file_size(output));
+    set_triangles(state, state.range(0));
+}
+
+//Construction of the backend Mesh from the arrays of a synthetic mesh, the counter bytes_per_triangle is the
+//memory of the triangulation (memory_usage) divided by the number of triangles
+template <typename Mesh>
+static void Backend_Memory(benchmark::State &state){
+    synthetic_mesh::mesh m = synthetic_mesh::generate(state.range(0), (synthetic_mesh::kind)state.range(1));
+    std::size_t bytes = 0;
+    for(auto _ : state){
+        Mesh tr(m.points, m.border, m.faces, m.neighs);
+        bytes = tr.memory_usage();
+        benchmark::DoNotOptimize(bytes);
+    }
+    std::size_t n_triangles = m.faces.size()/3;
+    state.counters["bytes"] = bytes;
+    state.counters["bytes_per_triangle"] = (double)bytes/n_triangles;
+    set_triangles(state, n_triangles);
+}
+
+//Rotation around every vertex of the backend Mesh with CW_edge_to_vertex, the halfedges of the rotation are
+//visited with next and twin to read their target, items_per_second is the number of halfedges visited
+template <typename Mesh>
+static void Backend_Traversal(benchmark::State &state){
+    synthetic_mesh::mesh m = synthetic_mesh::generate(state.range(0), (synthetic_mesh::kind)state.range(1));
+    Mesh tr(m.points, m.border, m.faces, m.neighs);
+    std::size_t visited = 0;
+    for(auto _ : state){
+        long long sum = 0;
+        visited = 0;
+        for(int v = 0; v < tr.vertices(); v++){
+            int start = tr.edge_of_vertex(v), e = start;
+            do{
+                sum += tr.origin(tr.twin(tr.next(e)));
+                e = tr.CW_edge_to_vertex(e);
+                visited++;
+            }while(e != start);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*visited);
+    state.counters["bytes_per_triangle"] = (double)tr.memory_usage()/tr.faces();
+    state.counters["triangles"] = tr.faces();
+}
+
+//Sizes from 10^3 to 10^7 triangles, uniform and anisotropic meshes
+static void mesh_sizes(benchmark::internal::Benchmark *b){
+    b->ArgsProduct({{1000, 10000, 100000, 1000000, 10000000}, {synthetic_mesh::UNIFORM, synthetic_mesh::ANISOTROPIC}});
+    b->ArgNames({"triangles", "anisotropic"});
+    b->Unit(benchmark::kMillisecond);
+}
+
+//The hash map of the pairs of vertices collides heavily, so it is only measured up to 10^5 triangles
+static void map_sizes(benchmark::internal::Benchmark *b){
+    b->ArgsProduct({{1000, 10000, 100000}, {synthetic_mesh::UNIFORM, synthetic_mesh::ANISOTROPIC}});
+    b->ArgNames({"triangles", "anisotropic"});
+    b->Unit(benchmark::kMillisecond);
+}
+
+//Meshes with a barrier-edge tip every 40 triangles, for the travel and the reparation
+static void spiral_sizes(benchmark::internal::Benchmark *b){
+    b->ArgsProduct({{1000, 10000, 100000, 1000000, 10000000}, {synthetic_mesh::SPIRALS}});
+    b->ArgNames({"triangles", "kind"});
+    b->Unit(benchmark::kMillisecond);
+}
+
+//Meshes of 10^5 and 10^6 triangles with each method of the longest edge
+static void longest_edge_sizes(benchmark::internal::Benchmark *b){
+    b->ArgsProduct({{100000, 1000000}, {synthetic_mesh::UNIFORM, synthetic_mesh::ANISOTROPIC}, {NAIVE, FILTERED, EXACT}});
+    b->ArgNames({"triangles", "anisotropic", "method"});
+    b->Unit(benchmark::kMillisecond);
+}
+
+//Meshes of 10^5 and 10^6 triangles with each kernel of max_edge_kernel.hpp
+static void kernel_sizes(benchmark::internal::Benchmark *b){
+    b->ArgsProduct({{100000, 1000000}, {synthetic_mesh::UNIFORM, synthetic_mesh::ANISOTROPIC},
+        {max_edge_kernel::SCALAR, max_edge_kernel::AVX2, max_edge_kernel::AVX512}});
+    b->ArgNames({"triangles", "anisotropic", "isa"});
+    b->Unit(benchmark::kMillisecond);
+}
+
+//10^4 to 10^7 points, uniform random and a grid, with 1 and 4 threads
+static void point_sizes(benchmark::internal::Benchmark *b){
+    b->ArgsProduct({{10000, 100000, 1000000, 10000000}, {0, 1}, {1, 4}});
+    b->ArgNames({"points", "grid", "threads"});
+    b->Unit(benchmark::kMillisecond);
+    b->UseRealTime();
+}
+
+static void thread_sizes(benchmark::internal::Benchmark *b){
+    b->ArgsProduct({{1000, 10000, 100000, 1000000, 10000000}, {synthetic_mesh::UNIFORM, synthetic_mesh::ANISOTROPIC}, {1, 2, 4, 8}});
+    b->ArgNames({"triangles", "anisotropic", "threads"});
+    b->Unit(benchmark::kMillisecond);
+    b->UseRealTime();
+}
+
+BENCHMARK(Parse_NodeEleNeigh)->Apply(mesh_sizes);
+BENCHMARK(Parse_OFF)->Apply(mesh_sizes);
+BENCHMARK(InteriorHalfEdges_Neighs)->Apply(mesh_sizes);
+BENCHMARK(InteriorHalfEdges_Faces)->Apply(mesh_sizes);
+BENCHMARK(TwinMatching_Map)->Apply(map_sizes);
+BENCHMARK(TwinMatching_RadixSort)->Apply(thread_sizes);
+BENCHMARK(ExteriorHalfEdges)->Apply(mesh_sizes);
+BENCHMARK(Delaunay)->Apply(point_sizes);
+BENCHMARK(Label_MaxEdges)->Apply(mesh_sizes);
+BENCHMARK(LongestEdge_Mesh)->Apply(longest_edge_sizes);
+BENCHMARK(LongestEdge_NearIsosceles)->ArgsProduct({{100000}, {NAIVE, FILTERED, EXACT}})->ArgNames({"triangles", "method"})->Unit(benchmark::kMillisecond);
+BENCHMARK(MaxEdgeKernel_Mesh)->Apply(kernel_sizes);
+BENCHMARK(MaxEdgeKernel_NearIsosceles)->ArgsProduct({{100000}, {max_edge_kernel::SCALAR, max_edge_kernel::AVX2, max_edge_kernel::AVX512}})->ArgNames({"triangles", "isa"})->Unit(benchmark::kMillisecond);
+BENCHMARK(Label_FrontierEdges)->Apply(mesh_sizes);
+BENCHMARK(Label_SeedEdges)->Apply(mesh_sizes);
+BENCHMARK(Travel)->Apply(mesh_sizes);
+BENCHMARK(Travel)->Apply(spiral_sizes);
+BENCHMARK(Reparation)->Apply(mesh_sizes);
+BENCHMARK(Reparation)->Apply(spiral_sizes);
+BENCHMARK(MoveVertices)->Apply(mesh_sizes);
+BENCHMARK(AddConstrainedEdges)->Apply(mesh_sizes);
+BENCHMARK(Adjacency)->Apply(mesh_sizes);
+BENCHMARK(Travel_Output)->ArgsProduct({{100000, 1000000, 10000000}, {synthetic_mesh::UNIFORM}, {0, 1}})->ArgNames({"triangles", "anisotropic", "stream"})->Unit(benchmark::kMillisecond);
+BENCHMARK(Output_OFF)->Apply(mesh_sizes);
+BENCHMARK(Output_ALE)->Apply(mesh_sizes);
+BENCHMARK_TEMPLATE(Backend_Memory, Triangulation)->Apply(mesh_sizes);
+BENCHMARK_TEMPLATE(Backend_Memory, CompactTriangulation)->Apply(mesh_sizes);
+BENCHMARK_TEMPLATE(Backend_Memory, CompressTriangulation)->Apply(mesh_sizes);
+BENCHMARK_TEMPLATE(Backend_Traversal, Triangulation)->Apply(mesh_sizes);
+BENCHMARK_TEMPLATE(Backend_Traversal, CompactTriangulation)->Apply(mesh_sizes);
+BENCHMARK_TEMPLATE(Backend_Traversal, CompressTriangulation)->Apply(mesh_sizes);
+
+BENCHMARK_MAIN();
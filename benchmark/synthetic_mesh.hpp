@@ -0,0 +1,223 @@
+/* Synthetic triangulations for the benchmarks
+    A grid of nx * ny cells, each cell is split in two triangles by one of its diagonals chosen randomly, so
+    the mesh has 2 * nx * ny triangles. The interior points are moved randomly up to 0.24 times the size of a
+    cell, this does not change the orientation of the triangles and avoids ties between the lengths of the edges.
+        uniform: cells of size 1 x 1
+        anisotropic: cells of size 1 x 0.001, so the triangles are needles
+    The spirals mesh has a barrier-edge tip in each cell of a grid of 1 x 1 cells. In the center of the cell there is
+    a fan of SPIRAL_SIDES triangles whose spokes grow in counterclockwise order, so the max edge of each triangle of the
+    fan is its last spoke and the first spoke is the only frontier edge of the center. The fan is joined to the
+    corners of the cell by a strip of triangles.
+    The mesh is written as .node/.ele/.neigh files and as an OFF file with the same points and triangles.
+*/
+
+#ifndef SYNTHETIC_MESH_HPP
+#define SYNTHETIC_MESH_HPP
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <filesystem>
+#include <algorithm>
+#include <utility>
+#include <mesh_writer.hpp>
+#include <twin_matching.hpp>
+
+namespace synthetic_mesh {
+
+enum kind {
+    UNIFORM,
+    ANISOTROPIC,
+    SPIRALS
+};
+
+inline const char *kind_name(kind k){
+    static const char *names[] = {"uniform", "anisotropic", "spirals"};
+    return names[k];
+}
+
+const int SPIRAL_SIDES = 12; //triangles of the fan of each cell of the spirals mesh
+
+struct mesh {
+    std::vector<double> points; //x, y of each vertex
+    std::vector<char> border; //true if the vertex is on the boundary
+    std::vector<int> faces; //three vertices of each triangle in counterclockwise order
+    std::vector<int> neighs; //neighbor of each triangle opposite to each vertex, -1 on the boundary
+};
+
+//Neighbors of the triangles of m, the neighbor opposite to the vertex k of a triangle shares the halfedge
+//that starts in the vertex k+1
+inline void set_neighs(mesh &m){
+    std::vector<int> twins = match_twins(m.faces, m.border.size()).twins;
+    m.neighs.resize(m.faces.size());
+    for(std::size_t t = 0; t < m.faces.size()/3; t++)
+        for(int k = 0; k < 3; k++){
+            int twin = twins[3*t + (k+1)%3];
+            m.neighs[3*t + k] = twin == -1 ? -1 : twin/3;
+        }
+}
+
+//Generate a grid of cells with a spiral fan in each one, with about n_triangles triangles
+//the spokes of the fan go from 0.2 to 0.3 and the sides of the fan are shorter than 0.2. The sides of the
+//cells are split in SIDE_POINTS segments, so the strip has short triangles
+inline mesh generate_spirals(std::size_t n_triangles){
+    const int SIDE_POINTS = 4;
+    const int n_cell = 2*SPIRAL_SIDES + 4*SIDE_POINTS; //triangles of a cell, fan and strip
+    int nx = std::max(1, (int)std::lround(std::sqrt((double)n_triangles/n_cell)));
+    int ny = std::max(1, (int)std::lround((double)n_triangles/(n_cell*nx)));
+    mesh m;
+    std::mt19937_64 rng(n_triangles*2 + SPIRALS);
+    std::uniform_real_distribution<double> rotation(0, 2*M_PI);
+    auto add_point = [&](double x, double y, bool border){
+        m.points.push_back(x);
+        m.points.push_back(y);
+        m.border.push_back(border);
+        return (int)m.border.size() - 1;
+    };
+    //points of the sides of the cells, in a lattice of step 1/SIDE_POINTS
+    int lx = SIDE_POINTS*nx + 1, ly = SIDE_POINTS*ny + 1;
+    std::vector<int> lattice(lx*ly, -1);
+    for(int J = 0; J < ly; J++)
+        for(int I = 0; I < lx; I++)
+            if(I % SIDE_POINTS == 0 || J % SIDE_POINTS == 0)
+                lattice[J*lx + I] = add_point((double)I/SIDE_POINTS, (double)J/SIDE_POINTS, I == 0 || J == 0 || I == lx - 1 || J == ly - 1);
+    auto orientation = [&](int a, int b, int c){
+        const double *p = m.points.data();
+        return (p[2*b] - p[2*a])*(p[2*c+1] - p[2*a+1]) - (p[2*b+1] - p[2*a+1])*(p[2*c] - p[2*a]);
+    };
+    for(int j = 0; j < ny; j++){
+        for(int i = 0; i < nx; i++){
+            double cx = i + 0.5, cy = j + 0.5;
+            int center = add_point(cx, cy, false);
+            //angle of a point from the center, measured counterclockwise from the corner (i, j)
+            double first = std::atan2(j - cy, i - cx);
+            auto angle = [&](int v){ return std::fmod(std::atan2(m.points[2*v+1] - cy, m.points[2*v] - cx) - first + 4*M_PI, 2*M_PI); };
+            //spokes in counterclockwise order from a random angle
+            double start = rotation(rng);
+            std::vector<std::pair<double, int>> inner, outer;
+            for(int s = 0; s < SPIRAL_SIDES; s++){
+                double a = start + 2*M_PI*s/SPIRAL_SIDES, r = 0.2 + 0.1*s/(SPIRAL_SIDES - 1);
+                int v = add_point(cx + r*std::cos(a), cy + r*std::sin(a), false);
+                inner.push_back({angle(v), v});
+            }
+            for(int s = 0; s < SPIRAL_SIDES; s++)
+                m.faces.insert(m.faces.end(), {center, inner[s].second, inner[(s+1)%SPIRAL_SIDES].second});
+            //sides of the cell in counterclockwise order from the corner (i, j)
+            int I = SIDE_POINTS*i, J = SIDE_POINTS*j;
+            for(int s = 0; s < SIDE_POINTS; s++)
+                outer.push_back({0, lattice[J*lx + I + s]});
+            for(int s = 0; s < SIDE_POINTS; s++)
+                outer.push_back({0, lattice[(J + s)*lx + I + SIDE_POINTS]});
+            for(int s = 0; s < SIDE_POINTS; s++)
+                outer.push_back({0, lattice[(J + SIDE_POINTS)*lx + I + SIDE_POINTS - s]});
+            for(int s = 0; s < SIDE_POINTS; s++)
+                outer.push_back({0, lattice[(J + SIDE_POINTS - s)*lx + I]});
+            for(std::size_t s = 1; s < outer.size(); s++)
+                outer[s].first = angle(outer[s].second);
+            //strip between the fan and the sides, both are visited in counterclockwise order from the corner (i, j)
+            //the next point is the one with the lowest angle, unless its triangle is not counterclockwise
+            std::sort(inner.begin(), inner.end());
+            outer.push_back({2*M_PI, outer[0].second});
+            inner.push_back({inner[0].first + 2*M_PI, inner[0].second});
+            std::size_t o = 0, in = 0;
+            while(o + 1 < outer.size() || in + 1 < inner.size()){
+                bool can_outer = o + 1 < outer.size() && orientation(outer[o].second, outer[o+1].second, inner[in].second) > 0;
+                bool can_inner = in + 1 < inner.size() && orientation(inner[in+1].second, inner[in].second, outer[o].second) > 0;
+                if(can_outer && (!can_inner || outer[o+1].first < inner[in+1].first)){
+                    m.faces.insert(m.faces.end(), {outer[o].second, outer[o+1].second, inner[in].second});
+                    o++;
+                }else{
+                    m.faces.insert(m.faces.end(), {inner[in+1].second, inner[in].second, outer[o].second});
+                    in++;
+                }
+            }
+        }
+    }
+    set_neighs(m);
+    return m;
+}
+
+//Generate a grid with about n_triangles triangles
+inline mesh generate(std::size_t n_triangles, kind k){
+    if(k == SPIRALS)
+        return generate_spirals(n_triangles);
+    int nx = std::max(1, (int)std::lround(std::sqrt(n_triangles/2.0)));
+    int ny = std::max(1, (int)std::lround(n_triangles/(2.0*nx)));
+    double sy = k == UNIFORM ? 1.0 : 1e-3;
+    mesh m;
+    std::mt19937_64 rng(n_triangles*2 + k);
+    std::uniform_real_distribution<double> jitter(-0.24, 0.24);
+    for(int j = 0; j <= ny; j++){
+        for(int i = 0; i <= nx; i++){
+            bool border = i == 0 || j == 0 || i == nx || j == ny;
+            double dx = border ? 0 : jitter(rng);
+            double dy = border ? 0 : jitter(rng);
+            m.points.push_back(i + dx);
+            m.points.push_back((j + dy)*sy);
+            m.border.push_back(border);
+        }
+    }
+    auto vertex = [&](int i, int j){ return j*(nx + 1) + i; };
+    std::bernoulli_distribution diagonal(0.5);
+    for(int j = 0; j < ny; j++){
+        for(int i = 0; i < nx; i++){
+            int a = vertex(i, j), b = vertex(i+1, j), c = vertex(i+1, j+1), d = vertex(i, j+1);
+            if(diagonal(rng))
+                m.faces.insert(m.faces.end(), {a, b, c, a, c, d});
+            else
+                m.faces.insert(m.faces.end(), {a, b, d, b, c, d});
+        }
+    }
+    set_neighs(m);
+    return m;
+}
+
+//Write the mesh in prefix.node, prefix.ele, prefix.neigh and prefix.off
+inline void write(const mesh &m, const std::string &prefix){
+    std::size_t n_vertices = m.border.size(), n_faces = m.faces.size()/3;
+    text_buffer b;
+    output_file node(prefix + ".node");
+    b.put(n_vertices).put(" 2 0 1\n");
+    for(std::size_t v = 0; v < n_vertices; v++)
+        b.put(v).put(' ').put(m.points[2*v], 17).put(' ').put(m.points[2*v+1], 17).put(' ').put((int)m.border[v]).put('\n');
+    node.write(b);
+    node.close();
+    b.clear();
+    output_file ele(prefix + ".ele");
+    b.put(n_faces).put(" 3 0\n");
+    for(std::size_t t = 0; t < n_faces; t++)
+        b.put(t).put(' ').put(m.faces[3*t]).put(' ').put(m.faces[3*t+1]).put(' ').put(m.faces[3*t+2]).put('\n');
+    ele.write(b);
+    ele.close();
+    b.clear();
+    output_file neigh(prefix + ".neigh");
+    b.put(n_faces).put(" 3\n");
+    for(std::size_t t = 0; t < n_faces; t++)
+        b.put(t).put(' ').put(m.neighs[3*t]).put(' ').put(m.neighs[3*t+1]).put(' ').put(m.neighs[3*t+2]).put('\n');
+    neigh.write(b);
+    neigh.close();
+    b.clear();
+    output_file off(prefix + ".off");
+    b.put("OFF\n").put(n_vertices).put(' ').put(n_faces).put(" 0\n");
+    for(std::size_t v = 0; v < n_vertices; v++)
+        b.put(m.points[2*v], 17).put(' ').put(m.points[2*v+1], 17).put(" 0\n");
+    for(std::size_t t = 0; t < n_faces; t++)
+        b.put("3 ").put(m.faces[3*t]).put(' ').put(m.faces[3*t+1]).put(' ').put(m.faces[3*t+2]).put('\n');
+    off.write(b);
+    off.close();
+}
+
+//Return the prefix of the files of the mesh, the files are generated the first time in the temporary directory
+inline std::string files(std::size_t n_triangles, kind k){
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "polylla_benchmark";
+    std::filesystem::create_directories(dir);
+    std::string prefix = (dir / (std::string(kind_name(k)) + "_" + std::to_string(n_triangles))).string();
+    if(!std::filesystem::exists(prefix + ".off"))
+        write(generate(n_triangles, k), prefix);
+    return prefix;
+}
+
+}
+
+#endif
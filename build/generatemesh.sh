@@ -6,18 +6,13 @@ fi
 file_folder="../data/"
 
 num_vertices="$1"
-node_file="points${num_vertices}.1.node"
-ele_file="points${num_vertices}.1.ele"
-neigh_file="points${num_vertices}.1.neigh"
-output_off="points${num_vertices}.1.off"
-output="points${num_vertices}.1"
+node_file="points${num_vertices}.node"
+output="points${num_vertices}"
 
-echo -n "Generating mesh with ${num_vertices} vertices..."
-cd ../data
-./datagenerator.sh "${num_vertices}"
-cd ../build
+echo -n "Generating ${num_vertices} random points..."
+python3 ${file_folder}10000x10000RandomPoints.py "${num_vertices}" > ${file_folder}${node_file}
 echo "done"
 
 echo -n "Generating mesh..."
-make && ./Polylla ${file_folder}${node_file} ${file_folder}${ele_file} ${file_folder}${neigh_file} ${file_folder}${output}
-echo "done"
\ No newline at end of file
+make && ./Polylla ${file_folder}${node_file} ${file_folder}${output}
+echo "done"
@@ -4,23 +4,75 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <polylla.hpp>
 
 #include <triangulation.hpp>
+#include <compact_triangulation.hpp>
+#include <compresshalfedge.hpp>
+#include <instrumentation.hpp>
+#include <batch.hpp>
+#include <out_of_core.hpp>
 
-//#include <compresshalfedge.hpp>
 //#include <io_void.hpp>
 //#include <delfin.hpp>
 //
 
-int main(int argc, char **argv) {
+//Options of the command line
+struct Options {
+    int n_threads = 1;
+    bool binary_output = false;
+    bool adjacency_output = false;
+    bool stream = false; //write the .off and .ale files while the polygons are generated
+    std::string stats_file; //file of the per-phase statistics, empty if they are not recorded
+    bool hardware_counters = false;
+    std::string batch; //manifest or directory of the batch mode, empty in the single mode
+    std::uintmax_t batch_memory = 0; //memory budget of the batch mode in bytes
+    std::uintmax_t tile_memory = 0; //memory budget of the out-of-core mode in bytes, 0 if the mesh is generated in memory
+    int n_processes = 0; //worker processes of the sharded mode, 0 if the mesh is generated in one process
+};
+
+//Write the output files of a mesh, the stream of the streaming mode has the .off and .ale files
+//Output: false if an output file could not be written
+template <typename Mesh>
+bool print_mesh(PolyllaMesh<Mesh> &mesh, std::string output, const polygon_stream *stream, const Options &opt){
+    //in the streaming mode the .off and .ale files were written while the mesh was generated
+    bool written = stream ? stream->good() : mesh.print_OFF(output+".off") && mesh.print_ALE(output+".ale");
+    if(!written)
+        return false;
+    std::cout<<"output off in "<<output<<".off"<<std::endl;
+    std::cout<<"output ale in "<<output<<".ale"<<std::endl;
+    if(opt.binary_output){
+        if(!mesh.print_binary(output+".hbin"))
+            return false;
+        std::cout<<"output binary mesh in "<<output<<".hbin"<<std::endl;
+    }
+    if(opt.adjacency_output){
+        if(!mesh.print_adjacency(output+".adj"))
+            return false;
+        std::cout<<"output polygon adjacency in "<<output<<".adj"<<std::endl;
+    }
+    return true;
+}
 
-    if(argc == 5)
+//Stream of the .off and .ale files of output in the streaming mode, else nullptr
+std::unique_ptr<polygon_stream> open_stream(const std::string &output, int n_threads, const Options &opt){
+    if(!opt.stream)
+        return nullptr;
+    return std::make_unique<polygon_stream>(output+".off", output+".ale", 4*resolve_threads(n_threads));
+}
+
+//Generate the mesh of the input files with the triangulation Mesh
+//The errors of the input files are thrown as exceptions
+//Output: exit status of the program, 1 if an output file could not be written
+template <typename Mesh>
+int generate(const std::vector<std::string> &args, const Options &opt){
+    if(args.size() == 4)
     {
-        std::string node_file = std::string(argv[1]);
-        std::string ele_file = std::string(argv[2]);
-        std::string neigh_file = std::string(argv[3]);
-        std::string output = std::string(argv[4]);
+        std::string node_file = args[0];
+        std::string ele_file = args[1];
+        std::string neigh_file = args[2];
+        std::string output = args[3];
 
         if(node_file.substr(node_file.find_last_of(".") + 1) != "node"){
             std::cout<<"Error: node file must be .node"<<std::endl;
@@ -35,29 +87,183 @@ int main(int argc, char **argv) {
             return 0;
         }
 
-        Polylla mesh(node_file, ele_file, neigh_file);
-        
-        mesh.print_OFF(output+".off");
-        std::cout<<"output off in "<<output<<".off"<<std::endl;
-        mesh.print_ALE(output+".ale");
-        std::cout<<"output ale in "<<output<<".ale"<<std::endl;
-    }else if (argc == 3){
-        std::string off_file = std::string(argv[1]);
-        std::string output = std::string(argv[2]);
-	    Polylla mesh(off_file);
-
-        mesh.print_OFF(output+".off");
-        std::cout<<"output off in "<<output<<".off"<<std::endl;
-        mesh.print_ALE(output+".ale");
-        std::cout<<"output ale in "<<output<<".ale"<<std::endl;
-    }else{
-        std::cout<<"Usage: "<<argv[0]<<" <off file .off> <output name>"<<std::endl;
-        std::cout<<"Usage: "<<argv[0]<<" <node_file .node> <ele_file .ele> <neigh_file .neigh> <output name>"<<std::endl;
+        std::unique_ptr<polygon_stream> stream = open_stream(output, opt.n_threads, opt);
+        PolyllaMesh<Mesh> mesh(node_file, ele_file, neigh_file, opt.n_threads, stream.get());
+        if(!print_mesh(mesh, output, stream.get(), opt))
+            return 1;
+    }else if (args.size() == 2){
+        std::string off_file = args[0];
+        std::string output = args[1];
+        std::unique_ptr<polygon_stream> stream = open_stream(output, opt.n_threads, opt);
+        PolyllaMesh<Mesh> mesh(off_file, opt.n_threads, stream.get());
+        if(!print_mesh(mesh, output, stream.get(), opt))
+            return 1;
+    }
+    return 0;
+}
+
+//Mesh a job of the batch mode with one thread, the threads of the batch run different jobs
+//The errors of the input files are thrown as exceptions, batch::run reports them as the error of the job
+template <typename Mesh>
+void generate_job(batch::job &job, const Options &opt){
+    const std::vector<std::string> &args = job.args;
+    std::unique_ptr<PolyllaMesh<Mesh>> mesh;
+    std::unique_ptr<polygon_stream> stream = open_stream(job.output(), 1, opt);
+    if(args.size() == 4)
+        mesh = std::make_unique<PolyllaMesh<Mesh>>(args[0], args[1], args[2], 1, stream.get());
+    else
+        mesh = std::make_unique<PolyllaMesh<Mesh>>(args[0], 1, stream.get());
+    if(!print_mesh(*mesh, job.output(), stream.get(), opt))
+        job.error = "unable to write the output files of " + job.output();
+    job.triangles = mesh->get_n_triangles();
+    job.polygons = mesh->get_n_polygons();
+}
+
+//Mesh the jobs of a manifest or a directory, each thread meshes a job at a time
+//Input: manifest or directory, output directory of a directory, empty for a manifest
+//Output: exit status of the program, 1 if any job failed
+template <typename Mesh>
+int generate_batch(const std::vector<std::string> &args, const Options &opt){
+    std::vector<batch::job> jobs;
+    try{
+        if(std::filesystem::is_directory(opt.batch)){
+            if(args.size() != 1){
+                std::cout<<"Error: the batch of a directory needs an output directory"<<std::endl;
+                return 0;
+            }
+            jobs = batch::read_directory(opt.batch, args[0]);
+        }else
+            jobs = batch::read_manifest(opt.batch);
+    }catch(const std::exception &e){
+        std::cout<<"Error: "<<e.what()<<std::endl;
+        return 1;
+    }
+    int n_threads = resolve_threads(opt.n_threads);
+    std::uintmax_t budget = opt.batch_memory > 0 ? opt.batch_memory : batch::default_memory_budget();
+    std::cout<<"Batch of "<<jobs.size()<<" jobs with "<<n_threads<<" threads and "<<budget/(1024*1024)<<" MB of memory"<<std::endl;
+    auto t_start = std::chrono::high_resolution_clock::now();
+    std::size_t n_failed = batch::run(jobs, n_threads, budget, [&](batch::job &job){ generate_job<Mesh>(job, opt); });
+    auto t_end = std::chrono::high_resolution_clock::now();
+    batch::print_summary(jobs, std::chrono::duration<double, std::milli>(t_end-t_start).count(), n_threads);
+    return n_failed > 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+
+    //Options are removed from the arguments, the remaining arguments are the input and output files
+    std::vector<std::string> args;
+    Options opt;
+    bool compact = false;
+    bool compressed = false;
+    for(int i = 1; i < argc; i++){
+        std::string arg = std::string(argv[i]);
+        if(arg == "--threads" && i + 1 < argc){
+            opt.n_threads = std::stoi(argv[++i]);
+        }else if(arg == "--binary"){
+            opt.binary_output = true;
+        }else if(arg == "--adjacency"){
+            opt.adjacency_output = true;
+        }else if(arg == "--stream"){
+            opt.stream = true;
+        }else if(arg == "--compact"){
+            compact = true;
+        }else if(arg == "--stats" && i + 1 < argc){
+            opt.stats_file = argv[++i];
+        }else if(arg == "--counters"){
+            opt.hardware_counters = true;
+        }else if(arg == "--compressed"){
+            compressed = true;
+        }else if(arg == "--batch" && i + 1 < argc){
+            opt.batch = argv[++i];
+        }else if(arg == "--batch-memory" && i + 1 < argc){
+            opt.batch_memory = std::stoull(argv[++i])*1024*1024;
+        }else if(arg == "--out-of-core" && i + 1 < argc){
+            opt.tile_memory = std::stoull(argv[++i])*1024*1024;
+        }else if(arg == "--processes" && i + 1 < argc){
+            opt.n_processes = std::stoi(argv[++i]);
+        }else
+            args.push_back(arg);
+    }
+
+    bool batch_args = !opt.batch.empty() && args.size() <= 1;
+    if(args.size() != 4 && args.size() != 2 && !batch_args){
+        std::cout<<"Usage: "<<argv[0]<<" <off file .off or binary mesh .hbin> <output name> [options]"<<std::endl;
+        std::cout<<"Usage: "<<argv[0]<<" <node_file .node> <output name> [options], the points are triangulated with a Delaunay triangulation"<<std::endl;
+        std::cout<<"Usage: "<<argv[0]<<" <node_file .node> <ele_file .ele> <neigh_file .neigh> <output name> [options]"<<std::endl;
+        std::cout<<"Usage: "<<argv[0]<<" --batch <manifest file> [options]"<<std::endl;
+        std::cout<<"Usage: "<<argv[0]<<" --batch <input directory> <output directory> [options]"<<std::endl;
+        std::cout<<"Options:"<<std::endl;
+        std::cout<<"  --threads <n>    number of threads, 0 uses all the hardware threads (default 1)"<<std::endl;
+        std::cout<<"  --binary         also write the mesh in the binary file <output name>.hbin, it can be used as input"<<std::endl;
+        std::cout<<"  --adjacency      also write the neighbors of each polygon in <output name>.adj"<<std::endl;
+        std::cout<<"  --stream         write the .off and .ale files while the polygons are generated, without storing them"<<std::endl;
+        std::cout<<"                   (can not be used with --binary or --adjacency)"<<std::endl;
+        std::cout<<"  --compact        use the compact triangulation, it stores only the origin and twin of each halfedge"<<std::endl;
+        std::cout<<"  --stats <file>   write the time, peak memory and number of elements of each phase in <file>, as CSV if it ends in .csv, else as JSON"<<std::endl;
+        std::cout<<"  --counters       also record cycles, cache misses and branch misses of each phase with perf_event_open, needs --stats"<<std::endl;
+        std::cout<<"  --compressed     use the compressed triangulation, it stores the halfedges with the minimum number of bits"<<std::endl;
+        std::cout<<"  --batch <path>   mesh the jobs of a manifest, one job per line with the files of a single run, or the meshes of a directory"<<std::endl;
+        std::cout<<"                   --threads is the number of jobs meshed at the same time, each job uses one thread"<<std::endl;
+        std::cout<<"  --batch-memory <MB>  memory budget of the jobs meshed at the same time (default half of the physical memory)"<<std::endl;
+        std::cout<<"  --out-of-core <MB>   mesh .node/.ele/.neigh files tile by tile with a memory budget, only the OFF file is written"<<std::endl;
+        std::cout<<"  --processes <n>      mesh the tiles of the out-of-core mode in n worker processes, the budget is shared by them"<<std::endl;
+        std::cout<<"                       (default budget half of the physical memory)"<<std::endl;
+        return 0;
+    }
+
+    //the polygons of the streaming mode are not stored, so the other outputs can not be written
+    if(opt.stream && (opt.binary_output || opt.adjacency_output)){
+        std::cout<<"Error: --stream can not be used with --binary or --adjacency"<<std::endl;
         return 0;
     }
-    
 
-    
-    
-	return 0;
+    if(!opt.batch.empty()){
+        //the statistics are of the whole process, so they can not be separated by job
+        if(!opt.stats_file.empty()){
+            std::cout<<"Error: --stats can not be used with --batch"<<std::endl;
+            return 0;
+        }
+        if(compressed)
+            return generate_batch<CompressTriangulation>(args, opt);
+        else if(compact)
+            return generate_batch<CompactTriangulation>(args, opt);
+        return generate_batch<Triangulation>(args, opt);
+    }
+
+    if(!opt.stats_file.empty())
+        instrumentation::get().enable(opt.hardware_counters);
+
+    if(opt.tile_memory > 0 || opt.n_processes > 0){
+        if(args.size() != 4){
+            std::cout<<"Error: --out-of-core and --processes need .node, .ele and .neigh files"<<std::endl;
+            return 0;
+        }
+        std::uintmax_t budget = opt.tile_memory > 0 ? opt.tile_memory : batch::default_memory_budget();
+        try{
+            out_of_core::generate(args[0], args[1], args[2], args[3] + ".off", budget, opt.n_processes, opt.n_threads);
+        }catch(const std::exception &e){
+            std::cout<<"Error: "<<e.what()<<std::endl;
+            return 1;
+        }
+        std::cout<<"output off in "<<args[3]<<".off"<<std::endl;
+    }else{
+        int status;
+        try{
+            if(compressed)
+                status = generate<CompressTriangulation>(args, opt);
+            else if(compact)
+                status = generate<CompactTriangulation>(args, opt);
+            else
+                status = generate<Triangulation>(args, opt);
+        }catch(const std::exception &e){
+            std::cout<<"Error: "<<e.what()<<std::endl;
+            return 1;
+        }
+        if(status != 0)
+            return status;
+    }
+
+    if(!opt.stats_file.empty() && instrumentation::get().write(opt.stats_file))
+        std::cout<<"output statistics in "<<opt.stats_file<<std::endl;
+    return 0;
 }
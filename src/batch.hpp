@@ -0,0 +1,248 @@
+/* Batch mode: mesh many inputs in one process
+    The jobs are read from a manifest with one job per line, with the same files of the command line:
+        <off file, binary mesh or node file> <output name>
+        <node file> <ele file> <neigh file> <output name>
+    Empty lines and lines that start with # are skipped. A directory is also a list of jobs: each .off and .hbin
+    file and each .node file with its .ele and .neigh files is a job, the output name is the name of the file
+    without extension in the output directory. A .node file without .ele and .neigh files is triangulated.
+
+    The jobs are independent, so they run at the same time in a pool of threads, each job with one thread.
+    The jobs are given with parallel_for_stealing, small and large inputs are mixed and a thread that ends its
+    jobs takes the jobs left to the other threads.
+    The memory is bounded by a budget: a job waits until the memory of the running jobs plus its own memory fits in
+    the budget, the memory of a job is estimated as MEMORY_PER_INPUT_BYTE times the size of its input files.
+    A job larger than the budget runs when no other job is running.
+
+    The input files are checked before a job starts, a missing file or a wrong extension is reported as a failed
+    job and the batch goes on. The errors found while reading a file or building a mesh are thrown as exceptions,
+    they are also reported as a failed job with the message of the exception.
+*/
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <unistd.h>
+#include <parallel.hpp>
+#include <mesh_writer.hpp>
+
+namespace batch {
+
+//Bytes of memory used by a job for each byte of its input files, the peak of an OFF file is about 5 times its size
+//and the peak of .node/.ele/.neigh files is about 2.2 times their size
+const std::uintmax_t MEMORY_PER_INPUT_BYTE = 5;
+
+struct job {
+    std::vector<std::string> args; //input files and output name, as in the command line
+    std::uintmax_t input_bytes = 0; //size of the input files
+    std::string error; //empty if the job ended without errors
+    double wall_ms = 0;
+    int triangles = 0;
+    int polygons = 0;
+
+    const std::string &output() const { return args.back(); }
+};
+
+//Return true if the file name ends in .extension
+inline bool has_extension(const std::string &file, const std::string &extension){
+    return std::filesystem::path(file).extension() == "." + extension;
+}
+
+//Check the input files of a job and set its input size
+//Output: true if the files can be read, else the error of the job is set
+inline bool check_inputs(job &j){
+    std::vector<std::string> inputs(j.args.begin(), j.args.end() - 1);
+    if(inputs.size() == 3){
+        const char *extensions[] = {"node", "ele", "neigh"};
+        for(int i = 0; i < 3; i++){
+            if(!has_extension(inputs[i], extensions[i])){
+                j.error = std::string(extensions[i]) + " file must be ." + extensions[i];
+                return false;
+            }
+        }
+    }
+    j.input_bytes = 0;
+    for(const std::string &file : inputs){
+        std::error_code ec;
+        std::uintmax_t size = std::filesystem::file_size(file, ec);
+        if(ec){
+            j.error = "can not read " + file;
+            return false;
+        }
+        j.input_bytes += size;
+    }
+    return true;
+}
+
+//Read the jobs of a manifest file
+//Throw std::runtime_error if the manifest can not be read or a line does not have the files of a job
+inline std::vector<job> read_manifest(const std::string &manifest){
+    std::vector<job> jobs;
+    std::ifstream in(manifest);
+    if(!in)
+        throw std::runtime_error("can not open the manifest " + manifest);
+    std::string line;
+    int line_number = 0;
+    while(std::getline(in, line)){
+        line_number++;
+        std::istringstream words(line);
+        job j;
+        std::string word;
+        while(words >> word)
+            j.args.push_back(word);
+        if(j.args.empty() || j.args[0][0] == '#')
+            continue;
+        if(j.args.size() != 2 && j.args.size() != 4)
+            throw std::runtime_error("line " + std::to_string(line_number) + " of " + manifest + " must have 2 or 4 files");
+        jobs.push_back(j);
+    }
+    return jobs;
+}
+
+//Read the jobs of the meshes of a directory, the outputs are written in output_dir
+//Throw std::runtime_error if the output directory is the input directory or a directory can not be read or created
+inline std::vector<job> read_directory(const std::string &dir, const std::string &output_dir){
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if(fs::equivalent(dir, output_dir, ec))
+        throw std::runtime_error("the output directory must be different of the input directory " + dir);
+    std::vector<fs::path> files;
+    for(const fs::directory_entry &entry : fs::directory_iterator(dir))
+        if(entry.is_regular_file())
+            files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+    std::vector<job> jobs;
+    for(const fs::path &file : files){
+        std::string output = (fs::path(output_dir) / file.stem()).string();
+        job j;
+        if(file.extension() == ".off" || file.extension() == ".hbin"){
+            j.args = {file.string(), output};
+        }else if(file.extension() == ".node"){
+            fs::path ele = fs::path(file).replace_extension(".ele");
+            fs::path neigh = fs::path(file).replace_extension(".neigh");
+            if(fs::exists(ele) && fs::exists(neigh))
+                j.args = {file.string(), ele.string(), neigh.string(), output};
+            else
+                j.args = {file.string(), output};
+        }else
+            continue;
+        jobs.push_back(j);
+    }
+    fs::create_directories(output_dir);
+    return jobs;
+}
+
+//Return half of the physical memory, the default memory budget
+inline std::uintmax_t default_memory_budget(){
+    long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGE_SIZE);
+    if(pages <= 0 || page_size <= 0)
+        return 0;
+    return (std::uintmax_t)pages*page_size/2;
+}
+
+//Memory reserved by the running jobs, acquire waits until the memory of a job fits in the budget
+class memory_budget
+{
+private:
+    std::mutex lock;
+    std::condition_variable released;
+    std::uintmax_t budget; //0 if the memory is not bounded
+    std::uintmax_t used = 0;
+
+public:
+    memory_budget(std::uintmax_t budget) : budget(budget) {}
+
+    void acquire(std::uintmax_t bytes){
+        std::unique_lock<std::mutex> guard(lock);
+        released.wait(guard, [&]{ return budget == 0 || used == 0 || used + bytes <= budget; });
+        used += bytes;
+    }
+
+    void release(std::uintmax_t bytes){
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            used -= bytes;
+        }
+        released.notify_all();
+    }
+};
+
+//Run the jobs with n_threads threads and a memory budget in bytes, 0 does not bound the memory
+//mesh_job(j) meshes the job j and sets its number of triangles and polygons, or its error
+//The output of the meshes is discarded, a line with the status and time of each job is printed when it ends
+//Output: number of failed jobs
+template <typename Function>
+std::size_t run(std::vector<job> &jobs, int n_threads, std::uintmax_t budget, Function mesh_job){
+    std::ostream log(std::cout.rdbuf());
+    null_buffer discarded;
+    std::mutex log_lock;
+    memory_budget memory(budget);
+    std::size_t n_done = 0, n_failed = 0;
+    //the output of the meshes is written to discarded while the jobs run
+    std::cout.rdbuf(&discarded);
+    parallel_for_stealing(0, jobs.size(), n_threads, [&](int, std::size_t i){
+        job &j = jobs[i];
+        if(check_inputs(j)){
+            std::uintmax_t bytes = j.input_bytes*MEMORY_PER_INPUT_BYTE;
+            memory.acquire(bytes);
+            auto t_start = std::chrono::high_resolution_clock::now();
+            try{
+                mesh_job(j);
+            }catch(const std::exception &e){
+                j.error = e.what();
+            }
+            auto t_end = std::chrono::high_resolution_clock::now();
+            memory.release(bytes);
+            j.wall_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
+        }
+        std::lock_guard<std::mutex> guard(log_lock);
+        log<<"["<<++n_done<<"/"<<jobs.size()<<"] ";
+        if(j.error.empty())
+            log<<"ok "<<j.wall_ms<<" ms "<<j.triangles<<" triangles "<<j.polygons<<" polygons "<<j.output()<<std::endl;
+        else{
+            log<<"failed: "<<j.error<<" "<<j.output()<<std::endl;
+            n_failed++;
+        }
+    });
+    std::cout.rdbuf(log.rdbuf());
+    return n_failed;
+}
+
+//Print the number of jobs, the failed jobs and the time of the batch
+inline void print_summary(const std::vector<job> &jobs, double wall_ms, int n_threads){
+    std::size_t n_failed = 0;
+    double jobs_ms = 0, max_ms = 0;
+    long long triangles = 0, polygons = 0;
+    for(const job &j : jobs){
+        if(!j.error.empty()){
+            n_failed++;
+            continue;
+        }
+        jobs_ms += j.wall_ms;
+        max_ms = std::max(max_ms, j.wall_ms);
+        triangles += j.triangles;
+        polygons += j.polygons;
+    }
+    std::cout<<"Batch of "<<jobs.size()<<" jobs with "<<n_threads<<" threads: "<<jobs.size() - n_failed<<" ok, "<<n_failed<<" failed"<<std::endl;
+    std::cout<<"Meshed "<<triangles<<" triangles in "<<polygons<<" polygons"<<std::endl;
+    std::cout<<"Batch time "<<wall_ms<<" ms, sum of the jobs "<<jobs_ms<<" ms, slowest job "<<max_ms<<" ms"<<std::endl;
+    for(const job &j : jobs)
+        if(!j.error.empty())
+            std::cout<<"Failed: "<<j.output()<<": "<<j.error<<std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,406 @@
+// Compact half-edge triangulation
+/*
+Triangulation where the halfedges of the triangles are implicit, only the origin and twin of each halfedge are stored.
+The halfedges of the triangle t are 3t, 3t+1 and 3t+2, so
+    next(e) = 3*(e/3) + (e+1)%3
+    prev(e) = 3*(e/3) + (e+2)%3
+    face(e) = e/3
+    target(e) = origin(next(e))
+Exterior halfedges (the faces outside the domain) are not triangles, they are stored after the 3n interior halfedges
+in a small table with their origin, twin, next and prev.
+This uses 8 bytes per interior halfedge instead of the 28 bytes of the halfEdge struct.
+The coordinates and the origins can be arrays of the caller (constructor from mesh_span with mesh_in_place), they are
+used in place and only the twins, the incident halfedges and the exterior halfedges are allocated.
+
+It has the same accessors of Triangulation, so it can be used by PolyllaMesh<CompactTriangulation>
+*/
+
+#ifndef COMPACT_TRIANGULATION_HPP
+#define COMPACT_TRIANGULATION_HPP
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <triangulation.hpp>
+#include <mesh_reader.hpp>
+#include <mesh_binary.hpp>
+#include <twin_matching.hpp>
+
+class CompactTriangulation
+{
+private:
+    struct exterior_halfEdge {
+        int origin;
+        int twin;
+        int next;
+        int prev;
+    };
+
+    int n_halfedges = 0; //number of halfedges, interior and exterior
+    int n_interior = 0; //number of interior halfedges, 3 * n_faces
+    int n_faces = 0; //number of faces
+    int n_vertices = 0; //number of vertices
+    mesh_array<double> X, Y; //coordinates of the vertices
+    std::vector<int> incident_halfedge; //halfedge with the vertex as origin
+    std::vector<char> border_vertex; //true if the vertex is on the boundary
+    mesh_array<int> Origins; //origin of each interior halfedge
+    std::vector<int> Twins; //twin of each interior halfedge, an exterior halfedge if the edge is on the boundary
+    std::vector<exterior_halfEdge> Exterior; //exterior halfedges, the halfedge n_interior + i is Exterior[i]
+
+    void set_vertices(const std::vector<double> &points){
+        n_vertices = points.size()/2;
+        X.resize(n_vertices);
+        Y.resize(n_vertices);
+        for(std::size_t i = 0; i < n_vertices; i++){
+            X[i] = points[2*i+0];
+            Y[i] = points[2*i+1];
+        }
+        incident_halfedge.assign(n_vertices, -1);
+        border_vertex.resize(n_vertices, false);
+    }
+
+    //Set the origin of the interior halfedges and the incident halfedge of each vertex
+    void set_origins(const std::vector<int> &faces){
+        Origins = mesh_array<int>(faces);
+        set_incident_halfedges();
+    }
+
+    //Set the incident halfedge of each vertex from the origins
+    void set_incident_halfedges(){
+        n_faces = Origins.size()/3;
+        n_interior = 3*n_faces;
+        for(std::size_t e = 0; e < n_interior; e++)
+            incident_halfedge.at(Origins[e]) = e;
+    }
+
+    //Generate the twin of each interior halfedge from the neighbors of each triangle
+    //Throw std::invalid_argument if a neighbor does not share the edge
+    void construct_twins_from_neighs(mesh_span<const int> neighs){
+        Twins.assign(n_interior, -1);
+        for(std::size_t e = 0; e < n_interior; e++){
+            //the neighbor opposite to the vertex (e+2)%3 shares the edge e
+            int n = neighs.at(3*(e/3) + (e+2)%3);
+            if(n == -1)
+                continue;
+            Twins[e] = twin_in_neighbor(Origins, e/3, n, Origins[e], Origins[next(e)]);
+        }
+    }
+
+    //Generate the twin of each interior halfedge from the faces
+    //the halfedges without twin are boundary edges and their vertices are marked as border
+    void construct_twins_from_faces(int n_threads){
+        twin_matching matching = match_twins(Origins, n_vertices, n_threads);
+        require_manifold(matching);
+        Twins = std::move(matching.twins);
+        for(std::size_t e = 0; e < n_interior; e++){
+            if(Twins[e] == -1){
+                border_vertex.at(Origins[e]) = true;
+                border_vertex.at(Origins[next(e)]) = true;
+            }
+        }
+    }
+
+    //Generate exterior halfedges
+    //each exterior halfedge is linked with the exterior halfedge that leaves its target
+    void construct_exterior_halfEdges(){
+        for(std::size_t e = 0; e < n_interior; e++){
+            if(Twins[e] == -1){
+                exterior_halfEdge ext;
+                ext.origin = Origins[next(e)];
+                ext.twin = e;
+                ext.next = -1;
+                ext.prev = -1;
+                Twins[e] = n_interior + Exterior.size();
+                Exterior.push_back(ext);
+            }
+        }
+        std::vector<int> exterior_edge_of_vertex(n_vertices, -1);
+        for(std::size_t i = 0; i < Exterior.size(); i++)
+            if(exterior_edge_of_vertex.at(Exterior[i].origin) == -1)
+                exterior_edge_of_vertex.at(Exterior[i].origin) = n_interior + i;
+        for(std::size_t i = 0; i < Exterior.size(); i++){
+            int nxt = exterior_edge_of_vertex.at(Origins[Exterior[i].twin]);
+            Exterior[i].next = nxt;
+            Exterior.at(nxt - n_interior).prev = n_interior + i;
+        }
+        n_halfedges = n_interior + Exterior.size();
+    }
+
+    //Generate the halfedges of the coordinates and origins given in memory, the twins are generated from
+    //the neighbors or matched from the faces if there are no neighbors
+    void construct_from_arrays(mesh_span<const int> neighs, int n_threads){
+        n_vertices = X.size();
+        incident_halfedge.assign(n_vertices, -1);
+        border_vertex.assign(n_vertices, false);
+        set_incident_halfedges();
+        if(neighs.empty())
+            construct_twins_from_faces(n_threads);
+        else{
+            construct_twins_from_neighs(neighs);
+            for(std::size_t e = 0; e < n_interior; e++){
+                if(Twins[e] == -1){
+                    border_vertex[Origins[e]] = true;
+                    border_vertex[Origins[next(e)]] = true;
+                }
+            }
+        }
+        construct_exterior_halfEdges();
+    }
+
+public:
+
+    //default constructor
+    CompactTriangulation() {}
+
+    //Constructor from file
+    CompactTriangulation(std::string node_file, std::string ele_file, std::string neigh_file, int n_threads = 1){
+        std::vector<double> points;
+        std::vector<int> faces, neighs;
+        std::cout<<"Reading node file"<<std::endl;
+        if(mesh_reader::read_node_file(node_file, points, border_vertex, n_threads) < 0)
+            throw std::runtime_error("unable to read the node file " + node_file);
+        set_vertices(points);
+        std::cout<<"Reading ele file"<<std::endl;
+        if(!mesh_reader::read_ele_file(ele_file, faces, n_threads))
+            throw std::runtime_error("unable to read the ele file " + ele_file);
+        set_origins(faces);
+        std::cout<<"Reading neigh file"<<std::endl;
+        if(!mesh_reader::read_neigh_file(neigh_file, neighs, n_threads))
+            throw std::runtime_error("unable to read the neigh file " + neigh_file);
+        construct_twins_from_neighs(neighs);
+        construct_exterior_halfEdges();
+    }
+
+    //Constructor from arrays
+    //Input: x, y and boundary marker of each vertex, vertices and neighbors of each triangle as in the .ele and .neigh files
+    CompactTriangulation(const std::vector<double> &points, const std::vector<char> &border, const std::vector<int> &faces, const std::vector<int> &neighs){
+        border_vertex = border;
+        set_vertices(points);
+        set_origins(faces);
+        construct_twins_from_neighs(neighs);
+        construct_exterior_halfEdges();
+    }
+
+    //Constructor from arrays in memory, x, y and triangles are copied
+    //Input: x and y of each vertex, three vertices of each triangle counterclockwise, neighbors of each triangle
+    //       as in the .neigh file or empty, then the twins are matched as in a OFF file
+    //The vertices of the edges without neighbor are the boundary
+    //Throw std::invalid_argument if the arrays are not a valid triangulation
+    CompactTriangulation(mesh_span<const double> x, mesh_span<const double> y, mesh_span<const int> triangles, mesh_span<const int> neighs = {}, int n_threads = 1){
+        require_mesh_arrays(x, y, triangles, neighs);
+        X = mesh_array<double>(std::vector<double>(x.begin(), x.end()));
+        Y = mesh_array<double>(std::vector<double>(y.begin(), y.end()));
+        Origins = mesh_array<int>(std::vector<int>(triangles.begin(), triangles.end()));
+        construct_from_arrays(neighs, n_threads);
+    }
+
+    //Constructor from arrays in memory, x, y and triangles are used in place without copying them
+    //Input: as in the constructor that copies the arrays
+    //The arrays must outlive the triangulation, moving the vertices of the mesh writes the new coordinates in x and y
+    CompactTriangulation(mesh_in_place_t, mesh_span<double> x, mesh_span<double> y, mesh_span<int> triangles, mesh_span<const int> neighs = {}, int n_threads = 1){
+        require_mesh_arrays(x, y, triangles, neighs);
+        X.view(x.data(), x.size());
+        Y.view(y.data(), y.size());
+        Origins.view(triangles.data(), triangles.size());
+        construct_from_arrays(neighs, n_threads);
+    }
+
+    //Constructor from a OFF file
+    CompactTriangulation(std::string OFF_file, int n_threads = 1){
+        std::vector<double> points;
+        std::vector<int> faces;
+        std::cout<<"Reading OFF file "<<OFF_file<<std::endl;
+        if(!mesh_reader::read_off_file(OFF_file, points, faces, n_threads))
+            throw std::runtime_error("unable to read the OFF file " + OFF_file);
+        set_vertices(points);
+        set_origins(faces);
+        construct_twins_from_faces(n_threads);
+        construct_exterior_halfEdges();
+    }
+
+    //Constructor from a binary mesh file, the halfedges of the file are compacted
+    CompactTriangulation(std::shared_ptr<mesh_binary::file> file){
+        Triangulation tr(file);
+        n_vertices = tr.vertices();
+        n_faces = tr.faces();
+        n_interior = 3*n_faces;
+        X.resize(n_vertices);
+        Y.resize(n_vertices);
+        incident_halfedge.resize(n_vertices);
+        border_vertex.resize(n_vertices);
+        for(std::size_t v = 0; v < n_vertices; v++){
+            X[v] = tr.get_PointX(v);
+            Y[v] = tr.get_PointY(v);
+            incident_halfedge[v] = tr.edge_of_vertex(v);
+            border_vertex[v] = tr.is_border_vertex(v);
+        }
+        Origins.resize(n_interior);
+        Twins.resize(n_interior);
+        for(std::size_t e = 0; e < n_interior; e++){
+            Origins[e] = tr.origin(e);
+            Twins[e] = tr.twin(e);
+        }
+        for(std::size_t e = n_interior; e < tr.halfEdges(); e++)
+            Exterior.push_back({tr.origin(e), tr.twin(e), tr.next(e), tr.prev(e)});
+        n_halfedges = tr.halfEdges();
+    }
+
+    //Add the triangulation to a binary mesh file, the halfedges are expanded to the halfEdge struct
+    void add_to_binary(mesh_binary::writer &out){
+        add_expanded_to_binary(*this, out);
+    }
+
+    //Return the number of bytes used by the triangulation, including the arrays used in place
+    std::size_t memory_usage(){
+        return (X.size() + Y.size())*sizeof(double) + incident_halfedge.size()*sizeof(int) + border_vertex.size()
+            + (Origins.size() + Twins.size())*sizeof(int) + Exterior.size()*sizeof(exterior_halfEdge);
+    }
+
+    // Calculates the distante of edge e
+    double distance(int e){
+        int v1 = origin(e);
+        int v2 = target(e);
+        return sqrt(pow(X.at(v1)-X.at(v2),2) + pow(Y.at(v1)-Y.at(v2),2));
+    }
+
+    int face_index(int e){
+        return e < n_interior ? e/3 : -1;
+    }
+
+    //Given a edge with vertex origin v, return the next coutnerclockwise edge of v with v as origin
+    //Input: e is the edge
+    //Output: the next counterclockwise edge of v
+    int CCW_edge_to_vertex(int e)
+    {
+        if(is_border_face(e))
+            return twin(prev(e));
+        return twin(next(next(e)));
+    }
+
+    //Given a edge with vertex origin v, return the prev clockwise edge of v with v as origin
+    //Input: e is the edge
+    //Output: the prev clockwise edge of v
+    int CW_edge_to_vertex(int e)
+    {
+        return next(twin(e));
+    }
+
+    //return number of faces
+    int faces(){
+        return n_faces;
+    }
+
+    //Return number of halfedges
+    int halfEdges(){
+        return n_halfedges;
+    }
+
+    //Return number of vertices
+    int vertices(){
+        return n_vertices;
+    }
+
+    //Return a halfedge of the face f
+    int edge_of_face(int f){
+        return 3*f;
+    }
+
+    double get_PointX(int i){
+        return X.at(i);
+    }
+
+    double get_PointY(int i){
+        return Y.at(i);
+    }
+
+    //Coordinates of the vertices, for max_edge_kernel.hpp
+    max_edge_kernel::point_arrays get_point_arrays(){
+        max_edge_kernel::point_arrays p;
+        p.x = X.data();
+        p.y = Y.data();
+        return p;
+    }
+
+    //Move the vertex i to (x, y), the halfedges are not changed
+    void set_Point(int i, double x, double y){
+        X.at(i) = x;
+        Y.at(i) = y;
+    }
+
+    //Calculates the next edge of the face incident to edge e
+    //Input: e is the edge
+    //Output: the next edge of the face incident to e
+    int next(int e){
+        if(e < n_interior)
+            return 3*(e/3) + (e+1)%3;
+        return Exterior.at(e - n_interior).next;
+    }
+
+    //Return the prev edge of the face incident to edge e
+    int prev(int e){
+        if(e < n_interior)
+            return 3*(e/3) + (e+2)%3;
+        return Exterior.at(e - n_interior).prev;
+    }
+
+    //Calculates the tail vertex of the edge e
+    //Input: e is the edge
+    //Output: the tail vertex v of the edge e
+    int origin(int e){
+        if(e < n_interior)
+            return Origins.at(e);
+        return Exterior.at(e - n_interior).origin;
+    }
+
+    //Calculates the head vertex of the edge e
+    //Input: e is the edge
+    //Output: the head vertex v of the edge e
+    int target(int e){
+        if(e < n_interior)
+            return Origins.at(next(e));
+        return Origins.at(Exterior.at(e - n_interior).twin);
+    }
+
+    //Return the twin edge of the edge e
+    //Input: e is the edge
+    //Output: the twin edge of e
+    int twin(int e){
+        if(e < n_interior)
+            return Twins.at(e);
+        return Exterior.at(e - n_interior).twin;
+    }
+
+    //return a edge associate to the node v
+    //Input: v is the node
+    //Output: the edge associate to the node v
+    int edge_of_vertex(int v){
+        return incident_halfedge.at(v);
+    }
+
+    //Input: edge e
+    //Output: true if is the face of e is border face
+    //        false otherwise
+    bool is_border_face(int e){
+        return e >= n_interior;
+    }
+
+    // Input: edge e
+    // Output: true if the edge is an interior face a
+    //         false otherwise
+    bool is_interior_face(int e){
+        return !this->is_border_face(e);
+    }
+
+    //Input:vertex v
+    //Output: true if the vertex v is part of the boundary
+    bool is_border_vertex(int v){
+        return border_vertex.at(v);
+    }
+};
+
+#endif
@@ -0,0 +1,391 @@
+// Compressed half-edge triangulation
+/*
+Succinct version of the compact triangulation for meshes that do not fit in memory as arrays of int.
+As in CompactTriangulation the halfedges of the triangle t are 3t, 3t+1 and 3t+2, so next, prev and face
+are calculated from the index, the rest is stored with the minimum number of bits:
+    Origins: origin of each interior halfedge, bits_for(n_vertices) bits each
+    Border: bit vector with a 1 for each interior halfedge without interior twin, with rank and select
+    Twins: twin of each interior halfedge with an interior twin, bits_for(3n) bits each,
+        the twin of the halfedge e is at position rank0(Border, e)
+    The k-th exterior halfedge is 3n + k, its twin is the k-th border halfedge, select1(Border, k),
+        and the twin of a border halfedge e is 3n + rank1(Border, e)
+    ExteriorNext, ExteriorPrev: next and prev of each exterior halfedge, relative to 3n
+    Incident: halfedge with the vertex as origin, BorderVertex: true if the vertex is on the boundary
+
+It has the same accessors of Triangulation, so it can be used by PolyllaMesh<CompressTriangulation>
+*/
+
+#ifndef COMPRESSHALFEDGE_HPP
+#define COMPRESSHALFEDGE_HPP
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <triangulation.hpp>
+#include <succinct.hpp>
+#include <twin_matching.hpp>
+#include <mesh_reader.hpp>
+#include <mesh_binary.hpp>
+
+class CompressTriangulation
+{
+private:
+    int n_halfedges = 0; //number of halfedges, interior and exterior
+    int n_interior = 0; //number of interior halfedges, 3 * n_faces
+    int n_faces = 0; //number of faces
+    int n_vertices = 0; //number of vertices
+    std::vector<double> X, Y; //coordinates of the vertices
+    packed_array Origins;
+    rank_select_bitvector Border;
+    packed_array Twins;
+    packed_array ExteriorNext;
+    packed_array ExteriorPrev;
+    packed_array Incident;
+    rank_select_bitvector BorderVertex;
+
+    void set_vertices(const std::vector<double> &points, const std::vector<char> &border){
+        n_vertices = points.size()/2;
+        X.resize(n_vertices);
+        Y.resize(n_vertices);
+        BorderVertex = rank_select_bitvector(n_vertices);
+        for(std::size_t i = 0; i < n_vertices; i++){
+            X[i] = points[2*i+0];
+            Y[i] = points[2*i+1];
+            BorderVertex.set(i, i < border.size() && border[i]);
+        }
+    }
+
+    //Compress the faces and the twins of the interior halfedges, -1 if the halfedge has no twin
+    //The values are checked before they are packed, a value out of range would be truncated to the width of the array
+    //Throw std::invalid_argument if a face has a vertex out of range or the twins are not symmetric
+    void set_halfedges(mesh_span<const int> faces, const std::vector<int> &twins){
+        require_mesh_arrays(n_vertices, faces, {});
+        if(twins.size() != faces.size())
+            throw std::invalid_argument("the mesh needs a twin per halfedge");
+        for(std::size_t e = 0; e < twins.size(); e++)
+            if(twins[e] < -1 || twins[e] >= (int)twins.size() || (twins[e] != -1 && twins[twins[e]] != (int)e))
+                throw std::invalid_argument("the halfedge " + std::to_string(e) + " has the twin " + std::to_string(twins[e]) + " that is not valid");
+        n_faces = faces.size()/3;
+        n_interior = 3*n_faces;
+        Origins = packed_array(n_interior, bits_for(n_vertices));
+        Border = rank_select_bitvector(n_interior);
+        for(std::size_t e = 0; e < n_interior; e++){
+            Origins.set(e, faces[e]);
+            Border.set(e, twins[e] == -1);
+        }
+        Border.build();
+        std::size_t n_exterior = Border.count();
+        n_halfedges = n_interior + n_exterior;
+        Twins = packed_array(n_interior - n_exterior, bits_for(n_interior));
+        Incident = packed_array(n_vertices, bits_for(n_halfedges));
+        for(std::size_t e = 0; e < n_interior; e++){
+            if(twins[e] != -1)
+                Twins.set(Border.rank0(e), twins[e]);
+            Incident.set(faces[e], e);
+        }
+        construct_exterior_halfEdges();
+    }
+
+    //Link the exterior halfedges with the exterior halfedge that leaves the target of each one
+    void construct_exterior_halfEdges(){
+        std::size_t n_exterior = n_halfedges - n_interior;
+        ExteriorNext = packed_array(n_exterior, bits_for(n_exterior));
+        ExteriorPrev = packed_array(n_exterior, bits_for(n_exterior));
+        std::vector<int> exterior_edge_of_vertex(n_vertices, -1);
+        for(std::size_t k = 0; k < n_exterior; k++){
+            int v = origin(n_interior + k);
+            if(exterior_edge_of_vertex.at(v) == -1)
+                exterior_edge_of_vertex.at(v) = k;
+        }
+        for(std::size_t k = 0; k < n_exterior; k++){
+            int nxt = exterior_edge_of_vertex.at(Origins.get(Border.select1(k)));
+            ExteriorNext.set(k, nxt);
+            ExteriorPrev.set(nxt, k);
+        }
+    }
+
+    //The neighbors of the .neigh file replaced by the twin of each halfedge, -1 on the boundary
+    //Throw std::invalid_argument if a neighbor does not share the edge
+    static std::vector<int> twins_from_neighs(mesh_span<const int> faces, mesh_span<const int> neighs){
+        std::vector<int> twins(faces.size(), -1);
+        for(std::size_t e = 0; e < faces.size(); e++){
+            int n = neighs.at(3*(e/3) + (e+2)%3);
+            if(n == -1)
+                continue;
+            twins[e] = twin_in_neighbor(faces, e/3, n, faces[e], faces[3*(e/3) + (e+1)%3]);
+        }
+        return twins;
+    }
+
+    //The vertices of the halfedges without twin are the boundary
+    static std::vector<char> border_from_twins(mesh_span<const int> faces, const std::vector<int> &twins, std::size_t n_vertices){
+        std::vector<char> border(n_vertices, false);
+        for(std::size_t e = 0; e < faces.size(); e++){
+            if(twins[e] == -1){
+                border.at(faces[e]) = true;
+                border.at(faces[3*(e/3) + (e+1)%3]) = true;
+            }
+        }
+        return border;
+    }
+
+public:
+
+    //default constructor
+    CompressTriangulation() {}
+
+    //Constructor from file
+    CompressTriangulation(std::string node_file, std::string ele_file, std::string neigh_file, int n_threads = 1){
+        std::vector<double> points;
+        std::vector<char> border;
+        std::vector<int> faces, neighs;
+        std::cout<<"Reading node file"<<std::endl;
+        if(mesh_reader::read_node_file(node_file, points, border, n_threads) < 0)
+            throw std::runtime_error("unable to read the node file " + node_file);
+        set_vertices(points, border);
+        std::vector<double>().swap(points);
+        std::cout<<"Reading ele file"<<std::endl;
+        if(!mesh_reader::read_ele_file(ele_file, faces, n_threads))
+            throw std::runtime_error("unable to read the ele file " + ele_file);
+        std::cout<<"Reading neigh file"<<std::endl;
+        if(!mesh_reader::read_neigh_file(neigh_file, neighs, n_threads))
+            throw std::runtime_error("unable to read the neigh file " + neigh_file);
+        require_mesh_arrays(n_vertices, faces, neighs);
+        std::vector<int> twins = twins_from_neighs(faces, neighs);
+        std::vector<int>().swap(neighs);
+        set_halfedges(faces, twins);
+    }
+
+    //Constructor from arrays
+    //Input: x, y and boundary marker of each vertex, vertices and neighbors of each triangle as in the .ele and .neigh files
+    CompressTriangulation(const std::vector<double> &points, const std::vector<char> &border, const std::vector<int> &faces, const std::vector<int> &neighs){
+        set_vertices(points, border);
+        set_halfedges(faces, twins_from_neighs(faces, neighs));
+    }
+
+    //Constructor from a OFF file
+    CompressTriangulation(std::string OFF_file, int n_threads = 1){
+        std::vector<double> points;
+        std::vector<int> faces;
+        std::cout<<"Reading OFF file "<<OFF_file<<std::endl;
+        if(!mesh_reader::read_off_file(OFF_file, points, faces, n_threads))
+            throw std::runtime_error("unable to read the OFF file " + OFF_file);
+        require_mesh_arrays(points.size()/2, faces, {});
+        twin_matching matching = match_twins(faces, points.size()/2, n_threads);
+        require_manifold(matching);
+        std::vector<int> &twins = matching.twins;
+        set_vertices(points, border_from_twins(faces, twins, points.size()/2));
+        set_halfedges(faces, twins);
+    }
+
+    //Constructor from arrays in memory, the coordinates and the halfedges are copied to the compressed arrays
+    //Input: x and y of each vertex, three vertices of each triangle counterclockwise, neighbors of each triangle
+    //       as in the .neigh file or empty, then the twins are matched as in a OFF file
+    //The vertices of the edges without neighbor are the boundary
+    //Throw std::invalid_argument if the arrays are not a valid triangulation
+    CompressTriangulation(mesh_span<const double> x, mesh_span<const double> y, mesh_span<const int> triangles, mesh_span<const int> neighs = {}, int n_threads = 1){
+        require_mesh_arrays(x, y, triangles, neighs);
+        std::vector<int> twins;
+        if(neighs.empty()){
+            twin_matching matching = match_twins(triangles, x.size(), n_threads);
+            require_manifold(matching);
+            twins = std::move(matching.twins);
+        }else
+            twins = twins_from_neighs(triangles, neighs);
+        std::vector<double> points(2*x.size());
+        for(std::size_t i = 0; i < x.size(); i++){
+            points[2*i+0] = x[i];
+            points[2*i+1] = y[i];
+        }
+        set_vertices(points, border_from_twins(triangles, twins, x.size()));
+        set_halfedges(triangles, twins);
+    }
+
+    //Compress another triangulation whose interior halfedges are 3t, 3t+1, 3t+2
+    //the indices of the halfedges are the same of tr
+    template <typename Mesh>
+    void compress_from(Mesh &tr){
+        std::vector<double> points(2*tr.vertices());
+        std::vector<char> border(tr.vertices());
+        for(std::size_t v = 0; v < tr.vertices(); v++){
+            points[2*v+0] = tr.get_PointX(v);
+            points[2*v+1] = tr.get_PointY(v);
+            border[v] = tr.is_border_vertex(v);
+        }
+        set_vertices(points, border);
+        std::vector<int> faces(3*tr.faces()), twins(3*tr.faces());
+        for(std::size_t e = 0; e < faces.size(); e++){
+            faces[e] = tr.origin(e);
+            twins[e] = tr.is_border_face(tr.twin(e)) ? -1 : tr.twin(e);
+        }
+        set_halfedges(faces, twins);
+        for(std::size_t v = 0; v < n_vertices; v++)
+            Incident.set(v, tr.edge_of_vertex(v));
+    }
+
+    //Constructor from a binary mesh file, the halfedges of the file are compressed
+    CompressTriangulation(std::shared_ptr<mesh_binary::file> file){
+        Triangulation tr(file);
+        compress_from(tr);
+    }
+
+    //Add the triangulation to a binary mesh file, the halfedges are expanded to the halfEdge struct
+    void add_to_binary(mesh_binary::writer &out){
+        add_expanded_to_binary(*this, out);
+    }
+
+    //Return the number of bytes used by the triangulation
+    std::size_t memory_usage(){
+        return (X.size() + Y.size())*sizeof(double) + Origins.bytes() + Border.bytes() + Twins.bytes()
+            + ExteriorNext.bytes() + ExteriorPrev.bytes() + Incident.bytes() + BorderVertex.bytes();
+    }
+
+    // Calculates the distante of edge e
+    double distance(int e){
+        int v1 = origin(e);
+        int v2 = target(e);
+        return sqrt(pow(X.at(v1)-X.at(v2),2) + pow(Y.at(v1)-Y.at(v2),2));
+    }
+
+    int face_index(int e){
+        return e < n_interior ? e/3 : -1;
+    }
+
+    //Given a edge with vertex origin v, return the next coutnerclockwise edge of v with v as origin
+    //Input: e is the edge
+    //Output: the next counterclockwise edge of v
+    int CCW_edge_to_vertex(int e)
+    {
+        if(is_border_face(e))
+            return twin(prev(e));
+        return twin(next(next(e)));
+    }
+
+    //Given a edge with vertex origin v, return the prev clockwise edge of v with v as origin
+    //Input: e is the edge
+    //Output: the prev clockwise edge of v
+    int CW_edge_to_vertex(int e)
+    {
+        return next(twin(e));
+    }
+
+    //return number of faces
+    int faces(){
+        return n_faces;
+    }
+
+    //Return number of halfedges
+    int halfEdges(){
+        return n_halfedges;
+    }
+
+    //Return number of vertices
+    int vertices(){
+        return n_vertices;
+    }
+
+    //Return a halfedge of the face f
+    int edge_of_face(int f){
+        return 3*f;
+    }
+
+    double get_PointX(int i){
+        return X.at(i);
+    }
+
+    double get_PointY(int i){
+        return Y.at(i);
+    }
+
+    //Coordinates of the vertices, for max_edge_kernel.hpp
+    max_edge_kernel::point_arrays get_point_arrays(){
+        max_edge_kernel::point_arrays p;
+        p.x = X.data();
+        p.y = Y.data();
+        return p;
+    }
+
+    //Move the vertex i to (x, y), the halfedges are not changed
+    void set_Point(int i, double x, double y){
+        X.at(i) = x;
+        Y.at(i) = y;
+    }
+
+    //Calculates the next edge of the face incident to edge e
+    //Input: e is the edge
+    //Output: the next edge of the face incident to e
+    int next(int e){
+        if(e < n_interior)
+            return 3*(e/3) + (e+1)%3;
+        return n_interior + ExteriorNext.get(e - n_interior);
+    }
+
+    //Return the prev edge of the face incident to edge e
+    int prev(int e){
+        if(e < n_interior)
+            return 3*(e/3) + (e+2)%3;
+        return n_interior + ExteriorPrev.get(e - n_interior);
+    }
+
+    //Calculates the tail vertex of the edge e
+    //Input: e is the edge
+    //Output: the tail vertex v of the edge e
+    int origin(int e){
+        if(e < n_interior)
+            return Origins.get(e);
+        //origin of an exterior halfedge is the target of its twin
+        return Origins.get(next(twin(e)));
+    }
+
+    //Calculates the head vertex of the edge e
+    //Input: e is the edge
+    //Output: the head vertex v of the edge e
+    int target(int e){
+        if(e < n_interior)
+            return Origins.get(next(e));
+        return Origins.get(twin(e));
+    }
+
+    //Return the twin edge of the edge e
+    //Input: e is the edge
+    //Output: the twin edge of e
+    int twin(int e){
+        if(e >= n_interior)
+            return Border.select1(e - n_interior);
+        if(Border.get(e))
+            return n_interior + Border.rank1(e);
+        return Twins.get(Border.rank0(e));
+    }
+
+    //return a edge associate to the node v
+    //Input: v is the node
+    //Output: the edge associate to the node v
+    int edge_of_vertex(int v){
+        return Incident.get(v);
+    }
+
+    //Input: edge e
+    //Output: true if is the face of e is border face
+    //        false otherwise
+    bool is_border_face(int e){
+        return e >= n_interior;
+    }
+
+    // Input: edge e
+    // Output: true if the edge is an interior face a
+    //         false otherwise
+    bool is_interior_face(int e){
+        return !this->is_border_face(e);
+    }
+
+    //Input:vertex v
+    //Output: true if the vertex v is part of the boundary
+    bool is_border_vertex(int v){
+        return BorderVertex.get(v);
+    }
+};
+
+#endif
@@ -0,0 +1,489 @@
+/* Delaunay triangulation of a set of points, so a .node file or the points in memory are meshed without
+    Triangle and without writing the .ele and .neigh files
+    triangulate(points, faces, neighs, border, n_threads): triangles and neighbors as in the .ele and .neigh files,
+        the triangles are counterclockwise and border is true for the vertices of the convex hull
+
+    The triangulation is the divide and conquer algorithm of Guibas and Stolfi (Primitives for the manipulation of
+    general subdivisions and the computation of Voronoi diagrams, 1985) with the quad-edge structure:
+    1. The points are sorted by x and then by y (radix sort of twin_matching.hpp), the repeated points are removed.
+    2. The points are split in two halves at the median until there are 2 or 3 points, the triangulations of the
+       halves are merged from the lower common tangent of their convex hulls to the upper one. The cuts alternate
+       between vertical and horizontal lines (Dwyer, A faster divide-and-conquer algorithm for constructing
+       Delaunay triangulations, 1987), so the halves are square and the merges are short, with vertical cuts only
+       the halves are thin strips and each merge crosses all of them. A horizontal cut is merged as a vertical one
+       with the points rotated 90 degrees, the predicates do not change with the rotation. The halves of the first
+       log2(n_threads) levels are triangulated in different threads.
+    3. The triangles are numbered from the vertex with the lowest position after the cuts, so the triangles of a
+       half are together and the output does not depend on the number of threads.
+    orient2d and incircle are the exact predicates of predicates.hpp, so degenerate inputs (collinear and
+    cocircular points, as in grids) give a valid triangulation. The cocircular points are split in triangles by
+    the order of the merges.
+
+    The quad-edges of all the threads are in one array with capacity for the 3n edges of a triangulation of n
+    points plus a margin: each thread takes blocks of EDGE_BLOCK edges and reuses the edges that it deletes.
+    The memory is about 120 bytes per point while the triangles are built. If the margin is not enough the
+    thread throws std::runtime_error, and the error of a thread is thrown again by its parent after the join.
+*/
+
+#ifndef DELAUNAY_HPP
+#define DELAUNAY_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <predicates.hpp>
+#include <parallel.hpp>
+#include <twin_matching.hpp>
+
+namespace delaunay {
+
+const int EDGE_BLOCK = 1024; //edges taken by a thread at a time
+const int PARALLEL_SIZE = 1 << 14; //halves with less points are triangulated in the thread of their parent
+
+//Quarter-edges of the edge e are 4e .. 4e+3, 4e and 4e+2 are the two directions of the edge
+//and 4e+1, 4e+3 are the edges of the dual
+inline int rot(int q) { return (q & ~3) | ((q + 1) & 3); }
+inline int sym(int q) { return q ^ 2; }
+inline int rot_inverse(int q) { return (q & ~3) | ((q + 3) & 3); }
+
+//A point of the triangulation and its index in the output
+struct site {
+    double x, y;
+    int vertex;
+};
+
+//Order of the points along the axis 0 (x, then y) or along the axis 1 (y, then -x, the points rotated 90 degrees)
+inline bool before(const site &a, const site &b, int axis){
+    if(axis == 0)
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    return a.y < b.y || (a.y == b.y && a.x > b.x);
+}
+
+//Edges taken by a thread, the deleted edges are linked by onext of their first quarter
+struct edge_allocator {
+    std::size_t next = 0, end = 0; //block of edges not used yet
+    int deleted = -1; //first deleted edge, -1 if there are none
+};
+
+class triangulator
+{
+private:
+    site *s; //points, the vertex i is s[i], the cuts reorder the points
+    std::vector<int> onext; //next counterclockwise quarter-edge with the same origin, 4 per edge
+    std::vector<int> origin; //origin of the quarter-edges 4e and 4e+2, -1 if the edge is deleted or not used
+    std::atomic<std::size_t> used{0}; //edges given to the threads
+    std::size_t capacity;
+
+public:
+    triangulator(site *sites, std::size_t n_vertices, int n_threads) : s(sites) {
+        capacity = 3*n_vertices + n_vertices/4 + (std::size_t)EDGE_BLOCK*(4*n_threads + 2);
+        onext.resize(4*capacity);
+        origin.assign(2*capacity, -1);
+    }
+
+    int org(int q) const { return origin[q >> 1]; }
+    int dest(int q) const { return origin[sym(q) >> 1]; }
+    int next_around_origin(int q) const { return onext[q]; }
+    int oprev(int q) const { return rot(onext[rot(q)]); }
+    int lnext(int q) const { return rot(onext[rot_inverse(q)]); }
+    int rprev(int q) const { return onext[sym(q)]; }
+    std::size_t edges() const { return used; }
+
+    //1 if the vertices a, b, c are counterclockwise, -1 if they are clockwise and 0 if they are collinear
+    int orientation(int a, int b, int c) const {
+        return predicates::orient2d(s[a].x, s[a].y, s[b].x, s[b].y, s[c].x, s[c].y);
+    }
+
+    bool ccw(int a, int b, int c) const { return orientation(a, b, c) > 0; }
+
+    //True if d is strictly inside the circle of the counterclockwise vertices a, b, c
+    //The merge tests vertices of the circle, their determinant is 0 and can not be decided by the filter
+    bool in_circle(int a, int b, int c, int d) const {
+        if(d == a || d == b || d == c)
+            return false;
+        return predicates::incircle(s[a].x, s[a].y, s[b].x, s[b].y, s[c].x, s[c].y, s[d].x, s[d].y) > 0;
+    }
+
+    bool right_of(int v, int q) const { return ccw(v, dest(q), org(q)); }
+    bool left_of(int v, int q) const { return ccw(v, org(q), dest(q)); }
+
+    //New edge from a to b, alone in its own faces
+    //Throw std::runtime_error if the capacity of the edges is exceeded
+    int make_edge(edge_allocator &alloc, int a, int b){
+        int e;
+        if(alloc.deleted != -1){
+            e = alloc.deleted;
+            alloc.deleted = onext[4*e];
+        }else{
+            if(alloc.next == alloc.end){
+                alloc.next = used.fetch_add(EDGE_BLOCK);
+                alloc.end = alloc.next + EDGE_BLOCK;
+                if(alloc.end > capacity)
+                    throw std::runtime_error("the Delaunay triangulation needs more edges than expected");
+            }
+            e = alloc.next++;
+        }
+        int q = 4*e;
+        onext[q] = q;
+        onext[q+1] = q+3;
+        onext[q+2] = q+2;
+        onext[q+3] = q+1;
+        origin[2*e] = a;
+        origin[2*e+1] = b;
+        return q;
+    }
+
+    //Join or split the rings of quarter-edges around the origins of a and b
+    void splice(int a, int b){
+        int alpha = rot(onext[a]), beta = rot(onext[b]);
+        std::swap(onext[a], onext[b]);
+        std::swap(onext[alpha], onext[beta]);
+    }
+
+    //New edge from the destination of a to the origin of b, in the left face of a and b
+    int connect(edge_allocator &alloc, int a, int b){
+        int q = make_edge(alloc, dest(a), org(b));
+        splice(q, lnext(a));
+        splice(sym(q), b);
+        return q;
+    }
+
+    void delete_edge(edge_allocator &alloc, int q){
+        splice(q, oprev(q));
+        splice(sym(q), oprev(sym(q)));
+        int e = q >> 2;
+        origin[2*e] = origin[2*e+1] = -1;
+        onext[4*e] = alloc.deleted;
+        alloc.deleted = e;
+    }
+
+    //Triangulate the vertices [lo, hi), at least 2, cutting them along axis
+    //Output: left, the counterclockwise convex hull edge out of the first vertex along axis,
+    //        right, the clockwise convex hull edge out of the last vertex along axis
+    //The halves of the first depth levels are triangulated in two threads, the error of the left half is thrown
+    //after both halves end, so the thread is always joined
+    void triangulate(int lo, int hi, int axis, int depth, edge_allocator &alloc, int &left, int &right){
+        int n = hi - lo;
+        auto order = [axis](const site &a, const site &b){ return before(a, b, axis); };
+        if(n <= 3)
+            std::sort(s + lo, s + hi, order);
+        if(n == 2){
+            int a = make_edge(alloc, lo, lo + 1);
+            left = a;
+            right = sym(a);
+            return;
+        }
+        if(n == 3){
+            int a = make_edge(alloc, lo, lo + 1);
+            int b = make_edge(alloc, lo + 1, lo + 2);
+            splice(sym(a), b);
+            int o = orientation(lo, lo + 1, lo + 2);
+            if(o > 0){
+                connect(alloc, b, a);
+                left = a;
+                right = sym(b);
+            }else if(o < 0){
+                int c = connect(alloc, b, a);
+                left = sym(c);
+                right = c;
+            }else{
+                left = a;
+                right = sym(b);
+            }
+            return;
+        }
+        int mid = lo + n/2;
+        std::nth_element(s + lo, s + mid, s + hi, order);
+        //the halves are cut along the other axis, their hull edges are moved to the extremes along axis
+        int ldo, ldi, rdi, rdo;
+        auto left_half = [&](edge_allocator &a){
+            triangulate(lo, mid, 1 - axis, depth - 1, a, ldo, ldi);
+            hull_extremes(axis, ldo, ldi);
+        };
+        auto right_half = [&](edge_allocator &a){
+            triangulate(mid, hi, 1 - axis, depth - 1, a, rdi, rdo);
+            hull_extremes(axis, rdi, rdo);
+        };
+        if(depth > 0 && n >= PARALLEL_SIZE){
+            edge_allocator left_alloc;
+            std::exception_ptr left_error;
+            std::thread left_thread([&]{
+                try{
+                    left_half(left_alloc);
+                }catch(...){
+                    left_error = std::current_exception();
+                }
+            });
+            try{
+                right_half(alloc);
+            }catch(...){
+                left_thread.join();
+                throw;
+            }
+            left_thread.join();
+            if(left_error)
+                std::rethrow_exception(left_error);
+        }else{
+            left_half(alloc);
+            right_half(alloc);
+        }
+        merge(alloc, ldo, ldi, rdi, rdo);
+        left = ldo;
+        right = rdo;
+    }
+
+    //Convex hull edges out of the first and last vertices along axis
+    //Input: right, a clockwise convex hull edge, its left face is the outer face
+    //Output: left, the counterclockwise convex hull edge out of the first vertex,
+    //        right, the clockwise convex hull edge out of the last vertex
+    void hull_extremes(int axis, int &left, int &right) const {
+        int start = right, q = start, first_in = start, last_out = start;
+        do{
+            if(before(s[dest(q)], s[dest(first_in)], axis))
+                first_in = q;
+            if(before(s[org(last_out)], s[org(q)], axis))
+                last_out = q;
+            q = lnext(q);
+        }while(q != start);
+        left = sym(first_in);
+        right = last_out;
+    }
+
+    //Merge the triangulations of two halves separated by a vertical line
+    //Input: ldo, ldi, convex hull edges of the left half out of its leftmost and rightmost vertices,
+    //       rdi, rdo, convex hull edges of the right half out of its leftmost and rightmost vertices
+    //Output: ldo and rdo are the convex hull edges of the merged triangulation
+    void merge(edge_allocator &alloc, int &ldo, int ldi, int rdi, int &rdo){
+        //lower common tangent of the two convex hulls
+        while(true){
+            if(left_of(org(rdi), ldi))
+                ldi = lnext(ldi);
+            else if(right_of(org(ldi), rdi))
+                rdi = rprev(rdi);
+            else
+                break;
+        }
+        int base = connect(alloc, sym(rdi), ldi);
+        if(org(ldi) == org(ldo))
+            ldo = sym(base);
+        if(org(rdi) == org(rdo))
+            rdo = base;
+        //add the edges between the halves from the lower tangent to the upper one, deleting the edges of each half
+        //whose triangles are not Delaunay with the vertices of the other half
+        while(true){
+            int lcand = onext[sym(base)];
+            if(right_of(dest(lcand), base)){
+                while(in_circle(dest(base), org(base), dest(lcand), dest(onext[lcand]))){
+                    int t = onext[lcand];
+                    delete_edge(alloc, lcand);
+                    lcand = t;
+                }
+            }
+            int rcand = oprev(base);
+            if(right_of(dest(rcand), base)){
+                while(in_circle(dest(base), org(base), dest(rcand), dest(oprev(rcand)))){
+                    int t = oprev(rcand);
+                    delete_edge(alloc, rcand);
+                    rcand = t;
+                }
+            }
+            bool lvalid = right_of(dest(lcand), base), rvalid = right_of(dest(rcand), base);
+            if(!lvalid && !rvalid)
+                break;
+            if(!lvalid || (rvalid && in_circle(dest(lcand), org(lcand), org(rcand), dest(rcand))))
+                base = connect(alloc, rcand, sym(base));
+            else
+                base = connect(alloc, sym(base), sym(lcand));
+        }
+    }
+};
+
+//Map a double to an unsigned integer with the same order, -0 and 0 are the same key
+inline uint64_t order_key(double value){
+    value += 0.0;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+//Delaunay triangulation of the points
+//Input: points x0 y0 x1 y1 ..., the repeated points are removed from points
+//Output: faces and neighs in the format of the .ele and .neigh files, border true for the vertices of the convex hull
+//        false if there are less than 3 different points or all the points are collinear
+//Throw std::runtime_error if the edges of the triangulation exceed their capacity, also in the threads
+inline bool triangulate(std::vector<double> &points, std::vector<int> &faces, std::vector<int> &neighs, std::vector<char> &border, int n_threads = 1){
+    n_threads = resolve_threads(n_threads);
+    std::size_t n_points = points.size()/2;
+    if(4*(3*n_points + n_points/4 + (std::size_t)EDGE_BLOCK*(4*n_threads + 2)) > INT_MAX){
+        std::cout<<"Error: too many points for the Delaunay triangulation"<<std::endl;
+        return false;
+    }
+
+    //1. sort the points by x with a radix sort, the points with the same x are sorted by y and by index
+    std::vector<uint64_t> keys(n_points);
+    std::vector<int> order(n_points);
+    parallel_for_blocks(0, n_points, n_threads, [&](int, std::size_t begin, std::size_t end){
+        for(std::size_t i = begin; i < end; i++){
+            keys[i] = order_key(points[2*i]);
+            order[i] = i;
+        }
+    });
+    radix_sort(keys, order, 64, n_threads);
+    auto by_y = [&](int a, int b){ return points[2*a+1] < points[2*b+1] || (points[2*a+1] == points[2*b+1] && a < b); };
+    parallel_for_blocks(0, n_points, n_threads, [&](int id, std::size_t begin, std::size_t end){
+        //the runs of the same x that start in the block
+        if(id > 0)
+            while(begin < end && keys[begin] == keys[begin - 1])
+                begin++;
+        while(begin < end){
+            std::size_t run_end = begin + 1;
+            while(run_end < n_points && keys[run_end] == keys[begin])
+                run_end++;
+            if(run_end - begin > 1)
+                std::sort(order.begin() + begin, order.begin() + run_end, by_y);
+            begin = run_end;
+        }
+    });
+    std::vector<uint64_t>().swap(keys);
+
+    //remove the repeated points, the first point in the input is kept
+    std::vector<char> repeated(n_points, false);
+    for(std::size_t i = 1; i < n_points; i++){
+        int a = order[i-1], b = order[i];
+        repeated[b] = points[2*a] == points[2*b] && points[2*a+1] == points[2*b+1];
+    }
+    std::vector<int> new_index(n_points);
+    std::size_t n_vertices = 0;
+    for(std::size_t i = 0; i < n_points; i++){
+        new_index[i] = n_vertices;
+        if(!repeated[i]){
+            points[2*n_vertices] = points[2*i];
+            points[2*n_vertices+1] = points[2*i+1];
+            n_vertices++;
+        }
+    }
+    if(n_vertices < n_points)
+        std::cout<<"Removed "<<n_points - n_vertices<<" repeated points"<<std::endl;
+    points.resize(2*n_vertices);
+    //sorted points and their index in the output
+    std::vector<site> sites(n_vertices);
+    std::size_t n_sorted = 0;
+    for(std::size_t i = 0; i < n_points; i++)
+        if(!repeated[order[i]])
+            sites[n_sorted++].vertex = new_index[order[i]];
+    std::vector<int>().swap(order);
+    std::vector<int>().swap(new_index);
+    std::vector<char>().swap(repeated);
+    if(n_vertices < 3){
+        std::cout<<"Error: the Delaunay triangulation needs at least 3 different points"<<std::endl;
+        return false;
+    }
+    parallel_for_blocks(0, n_vertices, n_threads, [&](int, std::size_t begin, std::size_t end){
+        for(std::size_t i = begin; i < end; i++){
+            sites[i].x = points[2*sites[i].vertex];
+            sites[i].y = points[2*sites[i].vertex+1];
+        }
+    });
+
+    //2. divide and conquer
+    triangulator tr(sites.data(), n_vertices, n_threads);
+    int depth = 0;
+    while((1 << depth) < n_threads)
+        depth++;
+    edge_allocator alloc;
+    int left, right;
+    tr.triangulate(0, n_vertices, 0, depth, alloc, left, right);
+
+    //the quarter-edges of the outer face, all the other faces are triangles
+    std::vector<char> outer(2*tr.edges(), false);
+    int q = right;
+    do{
+        outer[q >> 1] = true;
+        q = tr.lnext(q);
+    }while(q != right);
+
+    //3. triangles of each vertex, a triangle is numbered by its vertex of lowest position
+    std::vector<int> vertex_edge(n_vertices, -1);
+    for(std::size_t e = 0; e < tr.edges(); e++){
+        if(tr.org(4*e) == -1)
+            continue;
+        vertex_edge[tr.org(4*e)] = 4*e;
+        vertex_edge[tr.org(4*e+2)] = 4*e+2;
+    }
+    //first edge of the triangles of v, the edge to the neighbor of lowest position, so the order of the
+    //triangles does not depend on the numbering of the edges
+    auto first_edge = [&](int v){
+        int start = vertex_edge[v], q = start, first = start;
+        do{
+            if(tr.dest(q) < tr.dest(first))
+                first = q;
+            q = tr.next_around_origin(q);
+        }while(q != start);
+        return first;
+    };
+    std::vector<int> offsets(n_vertices + 1, 0);
+    border.assign(n_vertices, false);
+    parallel_for_blocks(0, n_vertices, n_threads, [&](int, std::size_t begin, std::size_t end){
+        for(std::size_t v = begin; v < end; v++){
+            int start = vertex_edge[v], q = start;
+            do{
+                if(outer[q >> 1])
+                    border[sites[v].vertex] = true;
+                else if((std::size_t)tr.dest(q) > v && (std::size_t)tr.dest(tr.lnext(q)) > v)
+                    offsets[v + 1]++;
+                q = tr.next_around_origin(q);
+            }while(q != start);
+        }
+    });
+    for(std::size_t v = 0; v < n_vertices; v++)
+        offsets[v + 1] += offsets[v];
+    std::size_t n_triangles = offsets[n_vertices];
+    if(n_triangles == 0){
+        std::cout<<"Error: the points are collinear, they have no Delaunay triangulation"<<std::endl;
+        return false;
+    }
+    faces.resize(3*n_triangles);
+    std::vector<int> triangle_edge(n_triangles);
+    std::vector<int> left_triangle(2*tr.edges(), -1); //triangle at the left of each quarter-edge 4e and 4e+2
+    parallel_for_blocks(0, n_vertices, n_threads, [&](int, std::size_t begin, std::size_t end){
+        for(std::size_t v = begin; v < end; v++){
+            if(offsets[v] == offsets[v + 1])
+                continue;
+            int t = offsets[v];
+            int start = first_edge(v), q = start;
+            do{
+                int l = tr.lnext(q);
+                if(!outer[q >> 1] && (std::size_t)tr.dest(q) > v && (std::size_t)tr.dest(l) > v){
+                    faces[3*t] = sites[v].vertex;
+                    faces[3*t+1] = sites[tr.dest(q)].vertex;
+                    faces[3*t+2] = sites[tr.dest(l)].vertex;
+                    triangle_edge[t] = q;
+                    left_triangle[q >> 1] = left_triangle[l >> 1] = left_triangle[tr.lnext(l) >> 1] = t;
+                    t++;
+                }
+                q = tr.next_around_origin(q);
+            }while(q != start);
+        }
+    });
+    //the neighbor i of a triangle is opposite to its vertex i, it shares the edge of the vertices i+1 and i+2
+    neighs.resize(3*n_triangles);
+    parallel_for_blocks(0, n_triangles, n_threads, [&](int, std::size_t begin, std::size_t end){
+        for(std::size_t t = begin; t < end; t++){
+            int q = triangle_edge[t];
+            for(int k = 0; k < 3; k++, q = tr.lnext(q))
+                neighs[3*t + (k+2)%3] = left_triangle[sym(q) >> 1];
+        }
+    });
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+/* Small set of halfedges for the reparation of barrier-edge tips
+    Open addressing with linear probing in a table of a power of two size, at least twice the number of
+    halfedges that will be inserted. Erased halfedges leave a tombstone, so the probe sequences are not cut.
+    reset(n) only clears a table of the size needed for n halfedges, so the cost of a reparation depends on
+    the number of barrier-edge tips of the polygon and not on the size of the mesh.
+*/
+
+#ifndef EDGE_SET_HPP
+#define EDGE_SET_HPP
+
+#include <vector>
+#include <cstdint>
+
+class edge_set
+{
+private:
+    static constexpr int EMPTY = -1;
+    static constexpr int ERASED = -2;
+    std::vector<int> table;
+    std::size_t mask = 0;
+
+    std::size_t slot(int e) const {
+        return ((uint32_t)e * 2654435761u) & mask;
+    }
+
+public:
+    //Remove all the halfedges, the set can hold n halfedges
+    void reset(std::size_t n){
+        std::size_t size = 8;
+        while(size < 2*n)
+            size *= 2;
+        table.assign(size, EMPTY);
+        mask = size - 1;
+    }
+
+    void insert(int e){
+        if(contains(e))
+            return;
+        std::size_t i = slot(e);
+        while(table[i] != EMPTY && table[i] != ERASED)
+            i = (i + 1) & mask;
+        table[i] = e;
+    }
+
+    bool contains(int e) const {
+        std::size_t i = slot(e);
+        while(table[i] != EMPTY){
+            if(table[i] == e)
+                return true;
+            i = (i + 1) & mask;
+        }
+        return false;
+    }
+
+    void erase(int e){
+        std::size_t i = slot(e);
+        while(table[i] != EMPTY){
+            if(table[i] == e){
+                table[i] = ERASED;
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+    }
+};
+
+#endif
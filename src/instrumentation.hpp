@@ -0,0 +1,228 @@
+/* Per-phase instrumentation of Polylla
+    Each phase records its wall time, the peak resident memory of the process at its end, the number of
+    elements it generated and, optionally, hardware counters read with perf_event_open (cycles, cache misses
+    and branch misses of this process and the threads it creates).
+    The records are written as JSON or CSV at the end of the run.
+
+    It is disabled by default, then begin, end and count only check a flag and nothing is measured.
+
+    instrumentation &stats = instrumentation::get();
+    stats.begin("label_max_edges");
+    ...
+    stats.end();
+    stats.count("max_edges", n); //added to the phase in progress or to the last phase ended
+*/
+
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <fstream>
+#include <utility>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+
+class instrumentation
+{
+public:
+    enum counter {
+        CYCLES,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        N_COUNTERS
+    };
+
+    struct phase {
+        std::string name;
+        int depth = 0; //number of phases that contain this phase
+        double wall_ms = 0;
+        long peak_rss_kb = 0; //peak resident memory of the process at the end of the phase
+        int64_t counters[N_COUNTERS] = {-1, -1, -1}; //-1 if the counter is not available
+        std::vector<std::pair<std::string, int64_t>> counts; //elements generated by the phase
+    };
+
+private:
+    bool enabled = false;
+    int fds[N_COUNTERS] = {-1, -1, -1};
+    std::vector<phase> phases;
+    //open phases: index in phases, start time and counters at the beginning
+    struct open_phase {
+        std::size_t index;
+        std::chrono::high_resolution_clock::time_point start;
+        int64_t counters[N_COUNTERS];
+    };
+    std::vector<open_phase> stack;
+    std::size_t last = 0; //last phase ended
+
+    instrumentation() {}
+
+    //Open a counter of this process, inherited by the threads created after it is opened
+    static int open_counter(uint32_t type, uint64_t config){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    void read_counters(int64_t *values){
+        for(int c = 0; c < N_COUNTERS; c++){
+            values[c] = -1;
+            uint64_t v;
+            if(fds[c] >= 0 && ::read(fds[c], &v, sizeof(v)) == sizeof(v))
+                values[c] = v;
+        }
+    }
+
+    static const char *counter_name(int c){
+        static const char *names[N_COUNTERS] = {"cycles", "cache_misses", "branch_misses"};
+        return names[c];
+    }
+
+public:
+    instrumentation(const instrumentation&) = delete;
+    instrumentation& operator=(const instrumentation&) = delete;
+
+    ~instrumentation(){
+        for(int c = 0; c < N_COUNTERS; c++)
+            if(fds[c] >= 0)
+                ::close(fds[c]);
+    }
+
+    //Instance used by the whole program
+    static instrumentation &get(){
+        static instrumentation stats;
+        return stats;
+    }
+
+    //Start recording the phases, with hardware counters if hardware_counters is true
+    void enable(bool hardware_counters = false){
+        enabled = true;
+        if(!hardware_counters)
+            return;
+        fds[CYCLES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[CACHE_MISSES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds[BRANCH_MISSES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        for(int c = 0; c < N_COUNTERS; c++)
+            if(fds[c] < 0)
+                std::cout<<"Hardware counter "<<counter_name(c)<<" is not available: "<<strerror(errno)<<std::endl;
+    }
+
+    bool is_enabled() const { return enabled; }
+
+    const std::vector<phase> &get_phases() const { return phases; }
+
+    //Start a phase, phases can be nested
+    void begin(const char *name){
+        if(!enabled)
+            return;
+        phase p;
+        p.name = name;
+        p.depth = stack.size();
+        phases.push_back(p);
+        open_phase o;
+        o.index = phases.size() - 1;
+        read_counters(o.counters);
+        o.start = std::chrono::high_resolution_clock::now();
+        stack.push_back(o);
+    }
+
+    //End the last phase started
+    void end(){
+        if(!enabled || stack.empty())
+            return;
+        auto t_end = std::chrono::high_resolution_clock::now();
+        int64_t values[N_COUNTERS];
+        read_counters(values);
+        open_phase o = stack.back();
+        stack.pop_back();
+        phase &p = phases[o.index];
+        p.wall_ms = std::chrono::duration<double, std::milli>(t_end - o.start).count();
+        for(int c = 0; c < N_COUNTERS; c++)
+            p.counters[c] = values[c] >= 0 && o.counters[c] >= 0 ? values[c] - o.counters[c] : -1;
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        p.peak_rss_kb = usage.ru_maxrss;
+        last = o.index;
+    }
+
+    //Add the number of elements of type name to the phase in progress, or to the last phase ended if there is none
+    void count(const char *name, int64_t n){
+        if(!enabled || phases.empty())
+            return;
+        phases[stack.empty() ? last : stack.back().index].counts.push_back({name, n});
+    }
+
+    //Write the phases in JSON, the counters that are not available are null
+    void write_json(std::ostream &out) const {
+        out<<"{\n  \"phases\": [";
+        for(std::size_t i = 0; i < phases.size(); i++){
+            const phase &p = phases[i];
+            out<<(i == 0 ? "\n" : ",\n");
+            out<<"    {\"name\": \""<<p.name<<"\", \"depth\": "<<p.depth<<", \"wall_ms\": "<<p.wall_ms;
+            out<<", \"peak_rss_kb\": "<<p.peak_rss_kb;
+            for(int c = 0; c < N_COUNTERS; c++){
+                out<<", \""<<counter_name(c)<<"\": ";
+                if(p.counters[c] >= 0)
+                    out<<p.counters[c];
+                else
+                    out<<"null";
+            }
+            out<<", \"counts\": {";
+            for(std::size_t j = 0; j < p.counts.size(); j++)
+                out<<(j == 0 ? "" : ", ")<<"\""<<p.counts[j].first<<"\": "<<p.counts[j].second;
+            out<<"}}";
+        }
+        out<<"\n  ]\n}\n";
+    }
+
+    //Write a line per phase in CSV, the counts are name=value pairs separated by ';'
+    //the counters that are not available are empty
+    void write_csv(std::ostream &out) const {
+        out<<"phase,depth,wall_ms,peak_rss_kb";
+        for(int c = 0; c < N_COUNTERS; c++)
+            out<<","<<counter_name(c);
+        out<<",counts\n";
+        for(const phase &p : phases){
+            out<<p.name<<","<<p.depth<<","<<p.wall_ms<<","<<p.peak_rss_kb;
+            for(int c = 0; c < N_COUNTERS; c++){
+                out<<",";
+                if(p.counters[c] >= 0)
+                    out<<p.counters[c];
+            }
+            out<<",";
+            for(std::size_t j = 0; j < p.counts.size(); j++)
+                out<<(j == 0 ? "" : ";")<<p.counts[j].first<<"="<<p.counts[j].second;
+            out<<"\n";
+        }
+    }
+
+    //Write the phases in filename, in CSV if its extension is .csv, else in JSON
+    bool write(const std::string &filename) const {
+        std::ofstream out(filename);
+        if(!out.is_open()){
+            std::cout<<"Unable to write the statistics file "<<filename<<std::endl;
+            return false;
+        }
+        if(filename.size() >= 4 && filename.substr(filename.size() - 4) == ".csv")
+            write_csv(out);
+        else
+            write_json(out);
+        return true;
+    }
+};
+
+#endif
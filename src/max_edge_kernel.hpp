@@ -0,0 +1,196 @@
+/* Longest edge of many triangles at once, for the label phase
+    longest_edges(points, v0, v1, v2, n, max) writes in max[t] the index in [0, 3) of the longest edge of the
+    triangle v0[t] v1[t] v2[t], the edge k goes from the corner k to the corner (k+1)%3.
+    The corners are given in three arrays (structure of arrays) and the coordinates of the vertex v are
+    points.x[v*points.stride] and points.y[v*points.stride], so the coordinates can be two arrays of doubles
+    (stride 1) or the x and y fields of an array of structs (Triangulation, stride 3).
+
+    The kernels compute the squared lengths of 4 (AVX2) or 8 (AVX-512) triangles with one instruction per
+    operation and apply the error filter of predicates::compare_lengths to the three comparisons of each triangle.
+    A triangle whose comparisons are not decided by the filter is computed again with predicates::longest_edge,
+    so the result is always the same of the scalar code, with the same order for the ties.
+    The vertices are widened to 64 bits before they are multiplied by the stride and gathered, so v*stride
+    does not overflow for any vertex of an int.
+    The kernel is chosen when the program starts from the instructions of the processor, the scalar loop is used
+    if the processor or the compiler do not support AVX2.
+*/
+
+#ifndef MAX_EDGE_KERNEL_HPP
+#define MAX_EDGE_KERNEL_HPP
+
+#include <cstddef>
+#include <predicates.hpp>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MAX_EDGE_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace max_edge_kernel {
+
+//Coordinates of the vertices of a triangulation, the vertex v is (x[v*stride], y[v*stride])
+struct point_arrays {
+    const double *x = nullptr;
+    const double *y = nullptr;
+    int stride = 1;
+};
+
+//Instructions used by longest_edges
+enum isa { SCALAR, AVX2, AVX512 };
+
+inline const char *isa_name(isa level){
+    const char *names[] = {"scalar", "AVX2", "AVX-512"};
+    return names[level];
+}
+
+//Longest edge of the triangle v0 v1 v2 with predicates::longest_edge
+inline unsigned char longest_edge(const point_arrays &p, int v0, int v1, int v2){
+    std::size_t i0 = (std::size_t)v0*p.stride, i1 = (std::size_t)v1*p.stride, i2 = (std::size_t)v2*p.stride;
+    return predicates::longest_edge(p.x[i0], p.y[i0], p.x[i1], p.y[i1], p.x[i2], p.y[i2]);
+}
+
+inline void longest_edges_scalar(const point_arrays &p, const int *v0, const int *v1, const int *v2, std::size_t n, unsigned char *max){
+    for(std::size_t t = 0; t < n; t++)
+        max[t] = longest_edge(p, v0[t], v1[t], v2[t]);
+}
+
+#ifdef MAX_EDGE_KERNEL_X86
+
+//Bits of the lanes whose comparison a - b is decided by the filter as positive (greater) or negative (less)
+__attribute__((target("avx2")))
+inline void filter_avx2(__m256d a, __m256d b, int &greater, int &less){
+    const __m256d error = _mm256_set1_pd(predicates::LENGTH_ERROR_BOUND);
+    __m256d difference = _mm256_sub_pd(a, b);
+    __m256d bound = _mm256_mul_pd(error, _mm256_add_pd(a, b));
+    greater = _mm256_movemask_pd(_mm256_cmp_pd(difference, bound, _CMP_GT_OQ));
+    less = _mm256_movemask_pd(_mm256_cmp_pd(difference, _mm256_sub_pd(_mm256_setzero_pd(), bound), _CMP_LT_OQ));
+}
+
+__attribute__((target("avx2")))
+inline __m256d squared_length_avx2(__m256d x0, __m256d y0, __m256d x1, __m256d y1){
+    __m256d dx = _mm256_sub_pd(x0, x1), dy = _mm256_sub_pd(y0, y1);
+    return _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+}
+
+//64-bit indices v[k]*stride of 4 vertices, the vertices are not negative
+__attribute__((target("avx2")))
+inline __m256i index_avx2(const int *v, __m256i stride){
+    return _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)v)), stride);
+}
+
+//Result of the lanes decided by the filter, bit k of each mask is the lane k
+//The comparisons of the decided lanes are strict, so the longest edge is the unique maximum
+inline void write_lanes(const point_arrays &p, const int *v0, const int *v1, const int *v2, int n_lanes,
+    int g01, int l01, int g12, int l12, int g20, int l20, unsigned char *max){
+    int decided = (g01 | l01) & (g12 | l12) & (g20 | l20);
+    int max0 = g01 & l20;
+    for(int k = 0; k < n_lanes; k++){
+        if(!(decided >> k & 1))
+            max[k] = longest_edge(p, v0[k], v1[k], v2[k]);
+        else
+            max[k] = (max0 >> k & 1) ? 0 : (g12 >> k & 1) ? 1 : 2;
+    }
+}
+
+__attribute__((target("avx2")))
+inline void longest_edges_avx2(const point_arrays &p, const int *v0, const int *v1, const int *v2, std::size_t n, unsigned char *max){
+    const __m256i stride = _mm256_set1_epi64x(p.stride);
+    std::size_t t = 0;
+    for(; t + 4 <= n; t += 4){
+        __m256i i0 = index_avx2(v0 + t, stride), i1 = index_avx2(v1 + t, stride), i2 = index_avx2(v2 + t, stride);
+        __m256d x0 = _mm256_i64gather_pd(p.x, i0, 8), y0 = _mm256_i64gather_pd(p.y, i0, 8);
+        __m256d x1 = _mm256_i64gather_pd(p.x, i1, 8), y1 = _mm256_i64gather_pd(p.y, i1, 8);
+        __m256d x2 = _mm256_i64gather_pd(p.x, i2, 8), y2 = _mm256_i64gather_pd(p.y, i2, 8);
+        __m256d l0 = squared_length_avx2(x0, y0, x1, y1);
+        __m256d l1 = squared_length_avx2(x1, y1, x2, y2);
+        __m256d l2 = squared_length_avx2(x2, y2, x0, y0);
+        int g01, l01, g12, l12, g20, l20;
+        filter_avx2(l0, l1, g01, l01);
+        filter_avx2(l1, l2, g12, l12);
+        filter_avx2(l2, l0, g20, l20);
+        write_lanes(p, v0 + t, v1 + t, v2 + t, 4, g01, l01, g12, l12, g20, l20, max + t);
+    }
+    longest_edges_scalar(p, v0 + t, v1 + t, v2 + t, n - t, max + t);
+}
+
+__attribute__((target("avx512f")))
+inline void filter_avx512(__m512d a, __m512d b, int &greater, int &less){
+    const __m512d error = _mm512_set1_pd(predicates::LENGTH_ERROR_BOUND);
+    __m512d difference = _mm512_sub_pd(a, b);
+    __m512d bound = _mm512_mul_pd(error, _mm512_add_pd(a, b));
+    greater = _mm512_cmp_pd_mask(difference, bound, _CMP_GT_OQ);
+    less = _mm512_cmp_pd_mask(difference, _mm512_sub_pd(_mm512_setzero_pd(), bound), _CMP_LT_OQ);
+}
+
+__attribute__((target("avx512f")))
+inline __m512d squared_length_avx512(__m512d x0, __m512d y0, __m512d x1, __m512d y1){
+    __m512d dx = _mm512_sub_pd(x0, x1), dy = _mm512_sub_pd(y0, y1);
+    return _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+}
+
+//64-bit indices v[k]*stride of 8 vertices, the vertices are not negative
+__attribute__((target("avx512f")))
+inline __m512i index_avx512(const int *v, __m512i stride){
+    return _mm512_mul_epi32(_mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)v)), stride);
+}
+
+__attribute__((target("avx512f")))
+inline void longest_edges_avx512(const point_arrays &p, const int *v0, const int *v1, const int *v2, std::size_t n, unsigned char *max){
+    const __m512i stride = _mm512_set1_epi64(p.stride);
+    std::size_t t = 0;
+    for(; t + 8 <= n; t += 8){
+        __m512i i0 = index_avx512(v0 + t, stride), i1 = index_avx512(v1 + t, stride), i2 = index_avx512(v2 + t, stride);
+        __m512d x0 = _mm512_i64gather_pd(i0, p.x, 8), y0 = _mm512_i64gather_pd(i0, p.y, 8);
+        __m512d x1 = _mm512_i64gather_pd(i1, p.x, 8), y1 = _mm512_i64gather_pd(i1, p.y, 8);
+        __m512d x2 = _mm512_i64gather_pd(i2, p.x, 8), y2 = _mm512_i64gather_pd(i2, p.y, 8);
+        __m512d l0 = squared_length_avx512(x0, y0, x1, y1);
+        __m512d l1 = squared_length_avx512(x1, y1, x2, y2);
+        __m512d l2 = squared_length_avx512(x2, y2, x0, y0);
+        int g01, l01, g12, l12, g20, l20;
+        filter_avx512(l0, l1, g01, l01);
+        filter_avx512(l1, l2, g12, l12);
+        filter_avx512(l2, l0, g20, l20);
+        write_lanes(p, v0 + t, v1 + t, v2 + t, 8, g01, l01, g12, l12, g20, l20, max + t);
+    }
+    longest_edges_avx2(p, v0 + t, v1 + t, v2 + t, n - t, max + t);
+}
+
+#endif
+
+//Best instructions supported by the processor and the compiler
+inline isa detect_isa(){
+#ifdef MAX_EDGE_KERNEL_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+        return AVX512;
+    if(__builtin_cpu_supports("avx2"))
+        return AVX2;
+#endif
+    return SCALAR;
+}
+
+//Instructions used by longest_edges, detected the first time it is called
+inline isa selected_isa(){
+    static const isa selected = detect_isa();
+    return selected;
+}
+
+//Longest edge of the triangles with the given instructions, level must be supported by the processor
+inline void longest_edges(isa level, const point_arrays &p, const int *v0, const int *v1, const int *v2, std::size_t n, unsigned char *max){
+#ifdef MAX_EDGE_KERNEL_X86
+    if(level == AVX512)
+        return longest_edges_avx512(p, v0, v1, v2, n, max);
+    if(level == AVX2)
+        return longest_edges_avx2(p, v0, v1, v2, n, max);
+#endif
+    longest_edges_scalar(p, v0, v1, v2, n, max);
+}
+
+//Longest edge of the triangles with the best instructions of the processor
+inline void longest_edges(const point_arrays &p, const int *v0, const int *v1, const int *v2, std::size_t n, unsigned char *max){
+    longest_edges(selected_isa(), p, v0, v1, v2, n, max);
+}
+
+}
+
+#endif
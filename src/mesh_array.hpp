@@ -0,0 +1,165 @@
+/* Array used to store the elements of the meshes
+    The array owns its elements in a std::vector or it is a view of memory owned by another object,
+    as a mesh mapped from a binary file, so the elements can be used in place without copying them.
+    Elements can only be added to the array when it owns its memory.
+
+    at(i): return the i-th element, checking the bounds
+    view(ptr, n): use the n elements in ptr without copying them
+    is_view(): true if the elements are not owned by the array
+
+    mesh_span<T> is a pointer and a size, the arrays given to the constructors from memory and the polygons of a mesh
+    are passed as spans without copying them. It is made from a pointer and a size or from a std::vector, a
+    mesh_array or another span, a span of const T also from a const container.
+
+    mesh_in_place selects the constructors from memory that use the arrays of the caller in place, the mesh writes
+    to them when its vertices are moved.
+*/
+
+#ifndef MESH_ARRAY_HPP
+#define MESH_ARRAY_HPP
+
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+template <typename T>
+class mesh_array
+{
+private:
+    std::vector<T> owned; //elements when the array owns its memory
+    T *ptr = nullptr; //first element, owned.data() or the viewed memory
+    std::size_t n = 0; //number of elements
+    bool viewed = false;
+
+    void sync(){
+        ptr = owned.data();
+        n = owned.size();
+    }
+
+public:
+    mesh_array() {}
+    mesh_array(std::size_t size, const T &value) : owned(size, value) { sync(); }
+    mesh_array(const std::vector<T> &v) : owned(v) { sync(); }
+    mesh_array(std::vector<T> &&v) : owned(std::move(v)) { sync(); }
+
+    mesh_array(const mesh_array &other) : owned(other.owned), viewed(other.viewed) {
+        if(viewed){
+            ptr = other.ptr;
+            n = other.n;
+        }else
+            sync();
+    }
+
+    mesh_array(mesh_array &&other) : owned(std::move(other.owned)), ptr(other.ptr), n(other.n), viewed(other.viewed) {
+        other.owned.clear();
+        other.sync();
+        other.viewed = false;
+    }
+
+    mesh_array &operator=(mesh_array other){
+        owned.swap(other.owned);
+        std::swap(viewed, other.viewed);
+        std::swap(ptr, other.ptr);
+        std::swap(n, other.n);
+        if(!viewed)
+            sync();
+        return *this;
+    }
+
+    //Use the n elements in p without copying them, the memory must outlive the array
+    void view(T *p, std::size_t size){
+        owned.clear();
+        owned.shrink_to_fit();
+        ptr = p;
+        n = size;
+        viewed = true;
+    }
+
+    bool is_view() const { return viewed; }
+
+    T &at(std::size_t i){
+        if(i >= n)
+            throw std::out_of_range("mesh_array::at");
+        return ptr[i];
+    }
+
+    const T &at(std::size_t i) const{
+        if(i >= n)
+            throw std::out_of_range("mesh_array::at");
+        return ptr[i];
+    }
+
+    T &operator[](std::size_t i) { return ptr[i]; }
+    const T &operator[](std::size_t i) const { return ptr[i]; }
+
+    std::size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    T *data() { return ptr; }
+    const T *data() const { return ptr; }
+    T *begin() { return ptr; }
+    T *end() { return ptr + n; }
+    const T *begin() const { return ptr; }
+    const T *end() const { return ptr + n; }
+    T &back() { return ptr[n-1]; }
+
+    //The following functions can only be used when the array owns its elements
+    void push_back(const T &value){
+        owned.push_back(value);
+        sync();
+    }
+
+    void reserve(std::size_t size){
+        owned.reserve(size);
+        sync();
+    }
+
+    void resize(std::size_t size){
+        owned.resize(size);
+        sync();
+    }
+
+    void clear(){
+        owned.clear();
+        sync();
+        viewed = false;
+    }
+};
+
+//Tag of the constructors that use the arrays of the caller in place instead of copying them
+struct mesh_in_place_t {
+    explicit mesh_in_place_t() = default;
+};
+
+inline constexpr mesh_in_place_t mesh_in_place{};
+
+template <typename T>
+class mesh_span
+{
+private:
+    T *ptr = nullptr;
+    std::size_t n = 0;
+
+public:
+    mesh_span() {}
+    mesh_span(T *p, std::size_t size) : ptr(p), n(size) {}
+
+    template <typename Container, typename = std::enable_if_t<
+        std::is_convertible<decltype(std::declval<Container &>().data()), T *>::value>>
+    mesh_span(Container &c) : ptr(c.data()), n(c.size()) {}
+
+    T &at(std::size_t i) const {
+        if(i >= n)
+            throw std::out_of_range("mesh_span::at");
+        return ptr[i];
+    }
+
+    T &operator[](std::size_t i) const { return ptr[i]; }
+    std::size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    T *data() const { return ptr; }
+    T *begin() const { return ptr; }
+    T *end() const { return ptr + n; }
+};
+
+#endif
@@ -0,0 +1,221 @@
+/* Binary mesh file (.hbin)
+    Versioned container with the arrays of a built Triangulation and, optionally, the labels and polygons
+    of a Polylla mesh. The file is a header followed by sections aligned to 64 bytes, each section is an
+    array stored exactly as it is in memory, so a mapped file can be used in place without copying or
+    linking the halfedges again.
+
+    Header:
+        magic "PLYHEDGE", version, endianness check, size of vertex and halfEdge structs,
+        number of vertices, faces, halfedges, polygons, frontier edges and barrier-edge tips,
+        offset and size in bytes of each section (0 if the section is not in the file)
+    Sections:
+        VERTICES, HALFEDGES, TRIANGLES: arrays of the triangulation
+        MAX_EDGES, FRONTIER_EDGES, SEED_EDGES: labels of the Polylla mesh
+        POLYGON_OFFSETS, POLYGON_VERTICES, POLYGON_SEEDS: polygons of the Polylla mesh, the vertices
+            of polygon i are POLYGON_VERTICES[POLYGON_OFFSETS[i] .. POLYGON_OFFSETS[i+1]]
+*/
+
+#ifndef MESH_BINARY_HPP
+#define MESH_BINARY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace mesh_binary {
+
+const char magic[8] = {'P','L','Y','H','E','D','G','E'};
+const uint32_t version = 1;
+const uint32_t endian_check = 0x01020304;
+const uint64_t alignment = 64;
+
+enum section {
+    VERTICES,
+    HALFEDGES,
+    TRIANGLES,
+    MAX_EDGES,
+    FRONTIER_EDGES,
+    SEED_EDGES,
+    POLYGON_OFFSETS,
+    POLYGON_VERTICES,
+    POLYGON_SEEDS,
+    N_SECTIONS
+};
+
+struct section_entry {
+    uint64_t offset = 0; //position of the section from the beginning of the file
+    uint64_t bytes = 0; //size of the section
+};
+
+struct header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint32_t vertex_size; //sizeof(vertex) when the file was written
+    uint32_t halfedge_size; //sizeof(halfEdge) when the file was written
+    int64_t n_vertices = 0;
+    int64_t n_faces = 0;
+    int64_t n_halfedges = 0;
+    int64_t n_polygons = 0;
+    int64_t n_frontier_edges = 0;
+    int64_t n_barrier_edge_tips = 0;
+    section_entry sections[N_SECTIONS];
+};
+
+//Return true if the file starts with the magic of a binary mesh file
+inline bool is_binary_file(const std::string &name){
+    char buffer[8];
+    std::ifstream in(name, std::ios::binary);
+    if(!in.read(buffer, 8))
+        return false;
+    return memcmp(buffer, magic, 8) == 0;
+}
+
+//Collect the sections of a binary mesh and write them in a file
+//The arrays are not copied, they must be alive until write is called, unless they are moved to the writer
+class writer
+{
+private:
+    header head;
+    const void *data[N_SECTIONS] = {nullptr};
+    std::vector<std::shared_ptr<void>> owned; //sections owned by the writer
+
+public:
+    writer(uint32_t vertex_size, uint32_t halfedge_size){
+        memcpy(head.magic, magic, 8);
+        head.version = version;
+        head.endian = endian_check;
+        head.vertex_size = vertex_size;
+        head.halfedge_size = halfedge_size;
+    }
+
+    header &get_header() { return head; }
+
+    void add_section(section s, const void *ptr, uint64_t bytes){
+        data[s] = ptr;
+        head.sections[s].bytes = bytes;
+    }
+
+    //Add a section owned by the writer, used for arrays generated only to be written
+    template <typename T>
+    void add_section(section s, std::vector<T> &&v){
+        auto p = std::make_shared<std::vector<T>>(std::move(v));
+        owned.push_back(p);
+        add_section(s, p->data(), p->size()*sizeof(T));
+    }
+
+    //Write the header and the sections, return false if the file can not be written
+    bool write(const std::string &name){
+        uint64_t offset = (sizeof(header) + alignment - 1) / alignment * alignment;
+        for(int s = 0; s < N_SECTIONS; s++){
+            head.sections[s].offset = head.sections[s].bytes > 0 ? offset : 0;
+            offset += (head.sections[s].bytes + alignment - 1) / alignment * alignment;
+        }
+        std::ofstream out(name, std::ios::binary);
+        if(!out.is_open()){
+            std::cout<<"Unable to write binary file "<<name<<std::endl;
+            return false;
+        }
+        const char padding[alignment] = {0};
+        uint64_t position = sizeof(header);
+        out.write(reinterpret_cast<const char*>(&head), sizeof(header));
+        for(int s = 0; s < N_SECTIONS; s++){
+            if(head.sections[s].bytes == 0)
+                continue;
+            out.write(padding, head.sections[s].offset - position);
+            out.write(static_cast<const char*>(data[s]), head.sections[s].bytes);
+            position = head.sections[s].offset + head.sections[s].bytes;
+        }
+        out.close();
+        //a full disk or an I/O error leaves a truncated file
+        if(!out.good()){
+            std::cout<<"Error writing binary file "<<name<<std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+//Binary mesh file mapped in memory
+//The mapping is private, so the arrays can be modified in place without changing the file
+class file
+{
+private:
+    int fd = -1;
+    std::size_t length = 0;
+    char *ptr = nullptr;
+
+    //Release the file and throw the error, the destructor is not called when the constructor throws
+    void fail(const std::string &message){
+        if(ptr != nullptr)
+            munmap(ptr, length);
+        if(fd >= 0)
+            ::close(fd);
+        ptr = nullptr;
+        fd = -1;
+        throw std::runtime_error(message);
+    }
+
+public:
+    //Map the file, throw std::runtime_error if it can not be mapped or it is not a valid binary mesh file
+    file(const std::string &name){
+        fd = ::open(name.c_str(), O_RDONLY);
+        struct stat st;
+        if(fd < 0 || fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(header))
+            fail("unable to open binary file " + name);
+        length = st.st_size;
+        void *addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED)
+            fail("unable to map binary file " + name);
+        ptr = static_cast<char*>(addr);
+        const header &h = get_header();
+        if(memcmp(h.magic, magic, 8) != 0 || h.endian != endian_check)
+            fail("the file " + name + " is not a binary mesh file of this machine");
+        if(h.version != version)
+            fail("binary mesh file version " + std::to_string(h.version) + " is not supported, expected version " + std::to_string(version));
+        for(int s = 0; s < N_SECTIONS; s++)
+            if(h.sections[s].offset + h.sections[s].bytes > length)
+                fail("the binary file " + name + " is truncated");
+    }
+
+    file(const file&) = delete;
+    file& operator=(const file&) = delete;
+
+    ~file(){
+        if(ptr != nullptr)
+            munmap(ptr, length);
+        if(fd >= 0)
+            ::close(fd);
+    }
+
+    const header &get_header() const { return *reinterpret_cast<const header*>(ptr); }
+
+    bool has(section s) const { return get_header().sections[s].bytes > 0; }
+
+    //Return the elements of the section s and their number in n, nullptr and 0 if the file does not have the section
+    //Throw std::runtime_error if the size of the section is not a multiple of the size of T
+    template <typename T>
+    T *get(section s, std::size_t &n){
+        const section_entry &entry = get_header().sections[s];
+        n = entry.bytes / sizeof(T);
+        if(entry.bytes % sizeof(T) != 0)
+            throw std::runtime_error("the section " + std::to_string(s) + " of the binary file has a wrong size");
+        if(entry.bytes == 0)
+            return nullptr;
+        return reinterpret_cast<T*>(ptr + entry.offset);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,377 @@
+/* Fast readers of the input files of the triangulation
+    The files are mapped in memory and parsed with std::from_chars, without building a stream per line.
+    The records of a file are split in chunks of lines that are parsed in parallel,
+    each record is written directly in its position of the output vectors.
+
+    read_node_file(name, points, border, n_threads): .node file, returns the first vertex index (0 or 1)
+    read_ele_file(name, faces, n_threads): .ele file, vertex indices start in 0
+    read_neigh_file(name, neighs, n_threads): .neigh file, triangle indices start in 0, -1 if there is no neighbor
+    read_off_file(name, points, faces, n_threads): OFF file with triangular faces
+    A file that can not be read, has less records than its header or a record with missing values is reported with
+    its name, read_node_file returns -1 and the others return false.
+
+    The outputs of the .node, .ele and .neigh readers can be any array with assign(n, value) and operator[],
+    as the arrays stored in files of the out-of-core mode.
+
+    Comments start with # and end at the end of the line. Extra columns (attributes and boundary markers)
+    are skipped according to the header of each file. Indices are 0-based or 1-based, the base is the
+    number of the first record of the file, as in Triangle.
+*/
+
+#ifndef MESH_READER_HPP
+#define MESH_READER_HPP
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <atomic>
+#include <parallel.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//Read only view of a file mapped in memory, the file is unmapped when the object is destroyed
+class mapped_file
+{
+private:
+    int fd = -1;
+    std::size_t length = 0;
+    const char *ptr = nullptr;
+
+public:
+    mapped_file(const std::string &name){
+        fd = ::open(name.c_str(), O_RDONLY);
+        if(fd < 0)
+            return;
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size == 0)
+            return;
+        length = st.st_size;
+        void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED){
+            length = 0;
+            return;
+        }
+        madvise(addr, length, MADV_SEQUENTIAL);
+        ptr = static_cast<const char*>(addr);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file(){
+        if(ptr != nullptr)
+            munmap(const_cast<char*>(ptr), length);
+        if(fd >= 0)
+            ::close(fd);
+    }
+
+    bool is_open() const { return ptr != nullptr; }
+    const char *begin() const { return ptr; }
+    const char *end() const { return ptr + length; }
+    std::size_t size() const { return length; }
+};
+
+namespace mesh_reader {
+
+inline bool is_blank(char c){
+    return c == ' ' || c == '\t' || c == '\r' || c == ',';
+}
+
+//Skip blanks inside a line
+inline const char *skip_blanks(const char *p, const char *end){
+    while(p < end && is_blank(*p))
+        p++;
+    return p;
+}
+
+//Return the end of the line that starts at p
+inline const char *line_end(const char *p, const char *end){
+    const char *nl = static_cast<const char*>(memchr(p, '\n', end - p));
+    return nl == nullptr ? end : nl;
+}
+
+//Return true if the line [p, end) has a record, i.e. it is not empty or a comment
+inline bool is_record(const char *p, const char *end){
+    p = skip_blanks(p, end);
+    return p < end && *p != '#';
+}
+
+//Read the next number of the line, return false if the line has no more numbers
+template <typename T>
+inline bool next_value(const char *&p, const char *end, T &value){
+    p = skip_blanks(p, end);
+    if(p >= end || *p == '#')
+        return false;
+    if(*p == '+')
+        p++;
+    auto result = std::from_chars(p, end, value);
+    if(result.ec != std::errc())
+        return false;
+    p = result.ptr;
+    return true;
+}
+
+//Return the first line with a record starting from p, the header of the files
+//Output: p points to the next line
+inline const char *next_record(const char *&p, const char *end, const char *&record_end){
+    while(p < end){
+        const char *b = p;
+        const char *e = line_end(p, end);
+        p = e < end ? e + 1 : end;
+        if(is_record(b, e)){
+            record_end = e;
+            return b;
+        }
+    }
+    record_end = end;
+    return end;
+}
+
+//Call parse(index, line_begin, line_end) for each record of [begin, end), index is the position of the record
+//The range is split in n_threads chunks of complete lines, the records of each chunk are counted
+//to calculate the index of the first record of each chunk and then the chunks are parsed in parallel
+//Output: number of records of the range
+template <typename Function>
+std::size_t parse_records(const char *begin, const char *end, int n_threads, Function parse){
+    if(end - begin < (1 << 20)) //small files are not worth the threads
+        n_threads = 1;
+    std::vector<const char*> chunk(n_threads + 1, end);
+    chunk[0] = begin;
+    for(int t = 1; t < n_threads; t++){
+        const char *p = begin + block_begin(end - begin, n_threads, t);
+        p = p < chunk[t-1] ? chunk[t-1] : p;
+        p = line_end(p, end);
+        chunk[t] = p < end ? p + 1 : end;
+    }
+    std::vector<std::size_t> first(n_threads + 1, 0);
+    if(n_threads > 1){
+        parallel_for_blocks(0, n_threads, n_threads, [&](int, std::size_t b, std::size_t e){
+            for(std::size_t t = b; t < e; t++){
+                std::size_t n = 0;
+                for(const char *p = chunk[t]; p < chunk[t+1];){
+                    const char *le = line_end(p, chunk[t+1]);
+                    if(is_record(p, le))
+                        n++;
+                    p = le + 1;
+                }
+                first[t+1] = n;
+            }
+        });
+        for(int t = 0; t < n_threads; t++)
+            first[t+1] += first[t];
+    }
+    std::vector<std::size_t> parsed(n_threads, 0);
+    parallel_for_blocks(0, n_threads, n_threads, [&](int, std::size_t b, std::size_t e){
+        for(std::size_t t = b; t < e; t++){
+            std::size_t index = first[t];
+            for(const char *p = chunk[t]; p < chunk[t+1];){
+                const char *le = line_end(p, chunk[t+1]);
+                if(is_record(p, le))
+                    parse(index++, p, le);
+                p = le + 1;
+            }
+            parsed[t] = index - first[t];
+        }
+    });
+    std::size_t n = 0;
+    for(int t = 0; t < n_threads; t++)
+        n += parsed[t];
+    return n;
+}
+
+//Return false and report the file if it has less records than its header or a record with missing values
+inline bool check_records(const std::string &name, const char *type, std::size_t n_records, std::size_t expected, bool missing_values){
+    if(n_records < expected){
+        std::cout<<"The "<<type<<" file "<<name<<" has "<<n_records<<" records, its header has "<<expected<<std::endl;
+        return false;
+    }
+    if(missing_values){
+        std::cout<<"The "<<type<<" file "<<name<<" has a record with missing values"<<std::endl;
+        return false;
+    }
+    return true;
+}
+
+//Read the first number of the first record of [p, end), used to know if the indices start in 0 or 1
+inline int first_index(const char *p, const char *end){
+    const char *record_end;
+    const char *record = next_record(p, end, record_end);
+    int index = 0;
+    next_value(record, record_end, index);
+    return index;
+}
+
+//Read a .node file
+//Input: name of the file, number of threads
+//Output: points with the x, y coordinates of each vertex, border with the boundary marker of each vertex
+//        returns the index of the first vertex (0 or 1), -1 if the file can not be read
+template <typename Points, typename Border>
+inline int read_node_file(const std::string &name, Points &points, Border &border, int n_threads = 1){
+    mapped_file file(name);
+    if(!file.is_open()){
+        std::cout<<"Unable to open node file "<<name<<std::endl;
+        return -1;
+    }
+    const char *p = file.begin(), *end = file.end(), *header_end;
+    const char *header = next_record(p, end, header_end);
+    long n_vertices = 0;
+    int dimension = 2, n_attributes = 0, n_markers = 0;
+    next_value(header, header_end, n_vertices);
+    next_value(header, header_end, dimension);
+    next_value(header, header_end, n_attributes);
+    next_value(header, header_end, n_markers);
+    int base = first_index(p, end);
+    points.assign(2*n_vertices, 0.0);
+    border.assign(n_vertices, false);
+    std::atomic<bool> missing(false);
+    std::size_t n_records = parse_records(p, end, n_threads, [&](std::size_t i, const char *b, const char *e){
+        if(i >= (std::size_t)n_vertices)
+            return;
+        long index;
+        double coordinate, attribute;
+        int marker = 0;
+        next_value(b, e, index);
+        if(!next_value(b, e, points[2*i+0]) || !next_value(b, e, points[2*i+1]))
+            missing = true;
+        for(int d = 2; d < dimension; d++)
+            next_value(b, e, coordinate);
+        for(int a = 0; a < n_attributes; a++)
+            next_value(b, e, attribute);
+        if(n_markers > 0 && next_value(b, e, marker))
+            border[i] = (marker == 1);
+    });
+    if(!check_records(name, "node", n_records, n_vertices, missing))
+        return -1;
+    return base;
+}
+
+//Read a .ele file, only the three corners of each triangle are read
+//Input: name of the file, number of threads
+//Output: faces with the three vertices of each triangle starting from 0
+//        returns false if the file can not be read
+template <typename Faces>
+inline bool read_ele_file(const std::string &name, Faces &faces, int n_threads = 1){
+    mapped_file file(name);
+    if(!file.is_open()){
+        std::cout<<"Unable to open ele file "<<name<<std::endl;
+        return false;
+    }
+    const char *p = file.begin(), *end = file.end(), *header_end;
+    const char *header = next_record(p, end, header_end);
+    long n_faces = 0;
+    next_value(header, header_end, n_faces);
+    int base = first_index(p, end);
+    faces.assign(3*n_faces, -1);
+    std::atomic<bool> missing(false);
+    std::size_t n_records = parse_records(p, end, n_threads, [&](std::size_t i, const char *b, const char *e){
+        if(i >= (std::size_t)n_faces)
+            return;
+        long index;
+        int v;
+        next_value(b, e, index);
+        for(int j = 0; j < 3; j++){
+            if(next_value(b, e, v))
+                faces[3*i+j] = v - base;
+            else
+                missing = true;
+        }
+    });
+    return check_records(name, "ele", n_records, n_faces, missing);
+}
+
+//Read a .neigh file
+//Input: name of the file, number of threads
+//Output: neighs with the three neighbors of each triangle starting from 0, -1 if the triangle has no neighbor
+//        returns false if the file can not be read
+template <typename Neighs>
+inline bool read_neigh_file(const std::string &name, Neighs &neighs, int n_threads = 1){
+    mapped_file file(name);
+    if(!file.is_open()){
+        std::cout<<"Unable to open neigh file "<<name<<std::endl;
+        return false;
+    }
+    const char *p = file.begin(), *end = file.end(), *header_end;
+    const char *header = next_record(p, end, header_end);
+    long n_faces = 0;
+    next_value(header, header_end, n_faces);
+    int base = first_index(p, end);
+    neighs.assign(3*n_faces, -1);
+    std::atomic<bool> missing(false);
+    std::size_t n_records = parse_records(p, end, n_threads, [&](std::size_t i, const char *b, const char *e){
+        if(i >= (std::size_t)n_faces)
+            return;
+        long index;
+        int n;
+        next_value(b, e, index);
+        for(int j = 0; j < 3; j++){
+            if(next_value(b, e, n))
+                neighs[3*i+j] = n < 0 ? -1 : n - base;
+            else
+                missing = true;
+        }
+    });
+    return check_records(name, "neigh", n_records, n_faces, missing);
+}
+
+//Read a OFF file with triangular faces
+//Input: name of the file, number of threads
+//Output: points with the x, y coordinates of each vertex, faces with the three vertices of each face
+//        returns false if the file can not be read, it is not an OFF file or it has a face that is not a triangle
+inline bool read_off_file(const std::string &name, std::vector<double> &points, std::vector<int> &faces, int n_threads = 1){
+    mapped_file file(name);
+    if(!file.is_open()){
+        std::cout<<"Unable to open OFF file "<<name<<std::endl;
+        return false;
+    }
+    const char *p = file.begin(), *end = file.end(), *record_end;
+    const char *record = next_record(p, end, record_end);
+    record = skip_blanks(record, record_end);
+    if(record_end - record < 3 || strncmp(record, "OFF", 3) != 0){
+        std::cout<<"The file is not an OFF file"<<std::endl;
+        return false;
+    }
+    //the counts can be in the same line of the OFF keyword
+    record += 3;
+    long n_vertices = 0, n_faces = 0;
+    if(!next_value(record, record_end, n_vertices)){
+        record = next_record(p, end, record_end);
+        next_value(record, record_end, n_vertices);
+    }
+    next_value(record, record_end, n_faces);
+    points.assign(2*n_vertices, 0.0);
+    faces.assign(3*n_faces, -1);
+    std::atomic<bool> missing(false), not_triangle(false);
+    std::size_t n_records = parse_records(p, end, n_threads, [&](std::size_t i, const char *b, const char *e){
+        if(i < (std::size_t)n_vertices){
+            if(!next_value(b, e, points[2*i+0]) || !next_value(b, e, points[2*i+1]))
+                missing = true;
+        }else if(i < (std::size_t)(n_vertices + n_faces)){
+            std::size_t f = i - n_vertices;
+            int length = 0, v;
+            if(!next_value(b, e, length) || length != 3){
+                not_triangle = true;
+                return;
+            }
+            for(int j = 0; j < 3; j++){
+                if(next_value(b, e, v))
+                    faces[3*f+j] = v;
+                else
+                    missing = true;
+            }
+        }
+    });
+    if(not_triangle){
+        std::cout<<"The OFF file "<<name<<" has a face that is not a triangle"<<std::endl;
+        return false;
+    }
+    return check_records(name, "OFF", n_records, n_vertices + n_faces, missing);
+}
+
+}
+
+#endif
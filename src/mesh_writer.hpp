@@ -0,0 +1,164 @@
+/* Buffered writers of the output files
+    Numbers are formatted with std::to_chars in large buffers that are written to the file with few syscalls.
+    Doubles are formatted as std::ostream does with std::setprecision, i.e. as printf("%.*g"),
+    so the files are the same as the ones written with operator<<.
+
+    text_buffer: characters of a part of a file
+    output_file: file written with large blocks, it fails if a block or the file can not be written
+    write_parallel(out, n, n_threads, format): format the items [0, n) in parallel blocks and write them in order
+    null_buffer: stream buffer that discards the output, std::cout.rdbuf(&null) silences the progress messages
+*/
+
+#ifndef MESH_WRITER_HPP
+#define MESH_WRITER_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <charconv>
+#include <parallel.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+//Characters of a part of a file, numbers are formatted with std::to_chars
+class text_buffer
+{
+private:
+    std::string buffer;
+
+public:
+    void reserve(std::size_t n) { buffer.reserve(n); }
+    void clear() { buffer.clear(); }
+    std::size_t size() const { return buffer.size(); }
+    const char *data() const { return buffer.data(); }
+
+    text_buffer &put(char c){
+        buffer.push_back(c);
+        return *this;
+    }
+
+    text_buffer &put(const char *s){
+        buffer.append(s);
+        return *this;
+    }
+
+    text_buffer &put(const std::string &s){
+        buffer.append(s);
+        return *this;
+    }
+
+    text_buffer &put(long long value){
+        char tmp[24];
+        auto result = std::to_chars(tmp, tmp + sizeof(tmp), value);
+        buffer.append(tmp, result.ptr);
+        return *this;
+    }
+
+    text_buffer &put(int value) { return put((long long)value); }
+    text_buffer &put(std::size_t value) { return put((long long)value); }
+
+    //Same output of out<<std::setprecision(precision)<<value
+    text_buffer &put(double value, int precision){
+        char tmp[64];
+        auto result = std::to_chars(tmp, tmp + sizeof(tmp), value, std::chars_format::general, precision);
+        buffer.append(tmp, result.ptr);
+        return *this;
+    }
+};
+
+//File written with large blocks, each call to write is a single syscall if possible
+//After an error the file is failed, the next writes are ignored and close returns false
+class output_file
+{
+private:
+    int fd = -1;
+    bool failed = false;
+
+    void fail(){
+        if(!failed)
+            std::cout<<"Error writing output file"<<std::endl;
+        failed = true;
+    }
+
+public:
+    output_file(const std::string &name){
+        fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0){
+            std::cout<<"Unable to open output file "<<name<<std::endl;
+            failed = true;
+        }
+    }
+
+    output_file(const output_file&) = delete;
+    output_file& operator=(const output_file&) = delete;
+
+    ~output_file(){
+        close();
+    }
+
+    bool is_open() const { return fd >= 0; }
+
+    //True if the file was opened and every write succeeded
+    bool good() const { return !failed; }
+
+    void write(const char *data, std::size_t n){
+        while(fd >= 0 && !failed && n > 0){
+            ssize_t written = ::write(fd, data, n);
+            if(written <= 0){
+                fail();
+                return;
+            }
+            data += written;
+            n -= written;
+        }
+    }
+
+    void write(const text_buffer &b){
+        write(b.data(), b.size());
+    }
+
+    //Write the n characters of data in the position offset of the file, used to patch headers
+    void write_at(const char *data, std::size_t n, std::size_t offset){
+        if(fd >= 0 && !failed && ::pwrite(fd, data, n, offset) != (ssize_t)n)
+            fail();
+    }
+
+    //Close the file, return false if it could not be written
+    bool close(){
+        if(fd >= 0 && ::close(fd) != 0)
+            fail();
+        fd = -1;
+        return !failed;
+    }
+};
+
+//Stream buffer that discards what is written, it has no state so the threads can write to it at the same time
+class null_buffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c == EOF ? 0 : c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+//Format the items [0, n) calling format(buffer, i) and write them in order in out
+//Items are processed in rounds of n_threads blocks, each thread formats a block in its own buffer
+//and the buffers are written in order, so the memory used is bounded by the size of a round
+template <typename Function>
+void write_parallel(output_file &out, std::size_t n, int n_threads, Function format, std::size_t block_size = 1 << 16){
+    std::vector<text_buffer> buffers(n_threads);
+    for(std::size_t round = 0; round < n; round += block_size*n_threads){
+        std::size_t round_end = std::min(n, round + block_size*n_threads);
+        parallel_for_blocks(round, round_end, n_threads, [&](int id, std::size_t begin, std::size_t end){
+            buffers[id].clear();
+            for(std::size_t i = begin; i < end; i++)
+                format(buffers[id], i);
+        });
+        for(auto &b : buffers){
+            out.write(b);
+            b.clear();
+        }
+    }
+}
+
+#endif
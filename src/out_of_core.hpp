@@ -0,0 +1,525 @@
+/* Out-of-core Polylla mesh of a triangulation larger than the memory
+    The input .node, .ele and .neigh files are parsed into arrays stored in scratch files mapped in memory
+    (file_array), their pages are written and read by the kernel, so they do not take anonymous memory.
+    The triangles are partitioned in spatial tiles and each tile is meshed in memory with PolyllaMesh:
+
+    1. The bounding box of the points is split in a grid of about 16 triangles per cell (at most GRID_CELLS x
+       GRID_CELLS cells) and the triangles are counted in the cell of their centroid. The cells are visited in
+       Morton order and joined in tiles of at most max_tile_triangles triangles, so each tile is a compact region
+       of the domain.
+    2. The triangles are sorted by tile with a counting sort in a scratch file.
+    3. Each tile is extended with the halo of triangles of other tiles that are in the terminal-edge regions of its
+       triangles: the regions are grown over the edges that are not frontier edges. The max edge of a triangle
+       only depends on its vertices, so the frontier edges are known without labeling the whole mesh.
+       Then every terminal-edge region of the tile and its halo is complete, the edges between the triangles of the
+       tile and the rest of the mesh are frontier edges and the labels, travel and reparation of a PolyllaMesh of
+       these triangles give the same polygons of the whole mesh.
+    4. The triangles of the tile are numbered in the order of the input, so the halfedges have the same order,
+       the seed edges and the reparations are the same of the whole mesh.
+       A polygon is written by the tile of the triangle of its seed edge, so the polygons of the regions that
+       cross the border of the tiles (stitched by the halo) are written once.
+
+    The polygons are written in a scratch file and the OFF file is written at the end, with the vertices of the
+    input. The polygons are the same of the in-memory mesh, their order is the order of the tiles.
+
+    The tiles are independent, so they can be meshed by worker processes (sharded mode). The workers are forked
+    after the partition and share the scratch files, each one takes the next tile from a counter in shared memory
+    and writes the polygons in its own file, the coordinator merges the files in the order of the tiles.
+    The processes do not share any memory that is written by more than one of them.
+
+    The memory of a tile is estimated as TRIANGLE_BYTES per triangle of the tile and its halo, the tiles have
+    memory_budget/(2*TRIANGLE_BYTES) triangles, so the halo can be as large as the tile.
+
+    The errors are thrown as std::runtime_error, or std::invalid_argument for a triangle with an index out of range,
+    and the scratch directory is removed when generate ends, also after an error.
+*/
+
+#ifndef OUT_OF_CORE_HPP
+#define OUT_OF_CORE_HPP
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <unordered_set>
+#include <memory>
+#include <atomic>
+#include <filesystem>
+#include <chrono>
+#include <stdexcept>
+#include <triangulation.hpp>
+#include <polylla.hpp>
+#include <mesh_reader.hpp>
+#include <mesh_writer.hpp>
+#include <instrumentation.hpp>
+#include <predicates.hpp>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//Array of T stored in a file mapped in memory, the file is removed when the array is destroyed
+//It has assign and operator[] as std::vector, so the mesh readers can parse into it
+template <typename T>
+class file_array
+{
+private:
+    std::string name;
+    int fd = -1;
+    T *ptr = nullptr;
+    std::size_t n = 0;
+
+    void unmap(){
+        if(ptr != nullptr)
+            munmap(ptr, n*sizeof(T));
+        ptr = nullptr;
+        n = 0;
+    }
+
+public:
+    file_array(const std::string &name) : name(name) {}
+
+    file_array(const file_array&) = delete;
+    file_array& operator=(const file_array&) = delete;
+
+    ~file_array(){
+        unmap();
+        if(fd >= 0){
+            ::close(fd);
+            ::unlink(name.c_str());
+        }
+    }
+
+    //Resize the file to n elements equal to value
+    //Throw std::runtime_error if the file can not be created or mapped
+    void assign(std::size_t size, const T &value){
+        unmap();
+        if(fd < 0)
+            fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0 || ftruncate(fd, size*sizeof(T)) != 0)
+            throw std::runtime_error("unable to create the scratch file " + name);
+        if(size > 0){
+            void *addr = mmap(nullptr, size*sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(addr == MAP_FAILED)
+                throw std::runtime_error("unable to map the scratch file " + name);
+            ptr = static_cast<T*>(addr);
+        }
+        n = size;
+        std::fill(ptr, ptr + n, value);
+    }
+
+    std::size_t size() const { return n; }
+    T *data() { return ptr; }
+    const T *data() const { return ptr; }
+    T &operator[](std::size_t i) { return ptr[i]; }
+    const T &operator[](std::size_t i) const { return ptr[i]; }
+};
+
+namespace out_of_core {
+
+const int GRID_CELLS = 1024; //maximum cells of each side of the grid used to partition the triangles
+const std::size_t TRIANGLE_BYTES = 256; //estimated memory of a triangle of a tile in PolyllaMesh
+const int TILES_PER_PROCESS = 4; //minimum number of tiles of each worker process
+
+//Interleave the bits of x and y, the Morton order of the cells
+inline uint32_t morton(uint32_t x, uint32_t y){
+    uint32_t key = 0;
+    for(int b = 0; b < 16; b++)
+        key |= ((x >> b) & 1) << (2*b) | ((y >> b) & 1) << (2*b + 1);
+    return key;
+}
+
+//Triangulation in scratch files and its tiles
+class tiled_triangulation
+{
+private:
+    file_array<double> points; //x, y of each vertex
+    file_array<char> border; //boundary marker of each vertex
+    file_array<int> faces; //three vertices of each triangle
+    file_array<int> neighs; //neighbor opposite to each vertex of each triangle, -1 if there is none
+    file_array<int> tile_of; //tile of each triangle
+    file_array<int> tile_triangles; //triangles sorted by tile
+    //index of each vertex and triangle in the triangulation of a tile, -1 if it is not in the tile
+    //each process has its own files, created by its first tile
+    std::string scratch;
+    std::unique_ptr<file_array<int>> local_vertex, local_triangle;
+    std::vector<std::size_t> tile_offsets; //triangles of the tile t are tile_triangles[tile_offsets[t] .. tile_offsets[t+1]]
+
+    //Return the index k in [0, 3) of the longest edge faces[3t+k]-faces[3t+(k+1)%3] of the triangle t,
+    //with the same predicate of PolyllaMesh::label_max_edge, so the ties are broken in the same way
+    int longest_edge(int t){
+        int v0 = faces[3*t], v1 = faces[3*t+1], v2 = faces[3*t+2];
+        return predicates::longest_edge(points[2*v0], points[2*v0+1], points[2*v1], points[2*v1+1],
+            points[2*v2], points[2*v2+1]);
+    }
+
+    //Neighbor of the triangle t through its edge k, the neighbor opposite to the vertex (k+2)%3
+    int neighbor(int t, int k){
+        return neighs[3*t + (k+2)%3];
+    }
+
+    //Return true if the edge k of the triangle t is not a frontier edge, so the triangle t and its neighbor n
+    //are in the same terminal-edge region
+    bool is_region_edge(int t, int k, int n){
+        if(longest_edge(t) == k)
+            return true;
+        int j = longest_edge(n);
+        return faces[3*n + j] == faces[3*t + (k+1)%3];
+    }
+
+public:
+    tiled_triangulation(const std::string &scratch) : points(scratch + "/points"), border(scratch + "/border"),
+        faces(scratch + "/faces"), neighs(scratch + "/neighs"), tile_of(scratch + "/tile_of"),
+        tile_triangles(scratch + "/tile_triangles"), scratch(scratch) {}
+
+    int vertices() { return border.size(); }
+    int faces_count() { return faces.size()/3; }
+    int tiles() { return tile_offsets.size() - 1; }
+    double get_PointX(int v) { return points[2*v]; }
+    double get_PointY(int v) { return points[2*v+1]; }
+
+    //Parse the input files in the scratch files
+    //Throw std::runtime_error if a file can not be read, std::invalid_argument if a triangle has a vertex or a
+    //neighbor out of range, so the tiles only index the arrays with valid indices
+    void read(const std::string &node_file, const std::string &ele_file, const std::string &neigh_file, int n_threads){
+        if(mesh_reader::read_node_file(node_file, points, border, n_threads) < 0)
+            throw std::runtime_error("unable to read the node file " + node_file);
+        if(!mesh_reader::read_ele_file(ele_file, faces, n_threads))
+            throw std::runtime_error("unable to read the ele file " + ele_file);
+        if(!mesh_reader::read_neigh_file(neigh_file, neighs, n_threads))
+            throw std::runtime_error("unable to read the neigh file " + neigh_file);
+        if(faces.size() != neighs.size())
+            throw std::runtime_error("the ele and neigh files have a different number of triangles");
+        require_mesh_arrays(border.size(), faces, neighs);
+    }
+
+    //Partition the triangles in tiles of at most max_tile_triangles triangles, a cell of the grid with more
+    //triangles is a tile by itself
+    void partition(std::size_t max_tile_triangles){
+        std::size_t n_faces = faces.size()/3;
+        //without triangles there are no tiles, and the bounding box of no points is not defined
+        if(n_faces == 0){
+            tile_offsets.assign(1, 0);
+            return;
+        }
+        double xmin = points[0], xmax = points[0], ymin = points[1], ymax = points[1];
+        for(std::size_t v = 0; v < border.size(); v++){
+            xmin = std::min(xmin, points[2*v]);
+            xmax = std::max(xmax, points[2*v]);
+            ymin = std::min(ymin, points[2*v+1]);
+            ymax = std::max(ymax, points[2*v+1]);
+        }
+        int grid = 1;
+        while(grid < GRID_CELLS && (std::size_t)grid*grid*16 < n_faces)
+            grid *= 2;
+        double sx = grid/std::max(xmax - xmin, 1e-300), sy = grid/std::max(ymax - ymin, 1e-300);
+        //cell of each triangle, stored in tile_of until the tiles are known
+        tile_of.assign(n_faces, 0);
+        std::vector<std::size_t> cell_count(grid*grid, 0);
+        for(std::size_t t = 0; t < n_faces; t++){
+            double x = 0, y = 0;
+            for(int k = 0; k < 3; k++){
+                x += points[2*faces[3*t+k]];
+                y += points[2*faces[3*t+k]+1];
+            }
+            int cx = std::min(grid - 1, std::max(0, (int)((x/3 - xmin)*sx)));
+            int cy = std::min(grid - 1, std::max(0, (int)((y/3 - ymin)*sy)));
+            tile_of[t] = cy*grid + cx;
+            cell_count[tile_of[t]]++;
+        }
+        //cells in Morton order joined in tiles
+        std::vector<std::pair<uint32_t, int>> cells(grid*grid);
+        for(std::size_t c = 0; c < cells.size(); c++)
+            cells[c] = {morton(c % grid, c / grid), (int)c};
+        std::sort(cells.begin(), cells.end());
+        std::vector<int> cell_tile(cells.size());
+        tile_offsets.assign(1, 0);
+        std::size_t in_tile = 0;
+        for(auto &cell : cells){
+            int c = cell.second;
+            if(in_tile > 0 && in_tile + cell_count[c] > max_tile_triangles){
+                tile_offsets.push_back(tile_offsets.back() + in_tile);
+                in_tile = 0;
+            }
+            cell_tile[c] = tile_offsets.size() - 1;
+            in_tile += cell_count[c];
+        }
+        tile_offsets.push_back(tile_offsets.back() + in_tile);
+        //counting sort of the triangles by tile, the triangles of each tile are in the order of the input
+        std::vector<std::size_t> next(tile_offsets.begin(), tile_offsets.end() - 1);
+        tile_triangles.assign(n_faces, 0);
+        for(std::size_t t = 0; t < n_faces; t++){
+            tile_of[t] = cell_tile[tile_of[t]];
+            tile_triangles[next[tile_of[t]]++] = t;
+        }
+    }
+
+    //Triangles of the tile and its halo, sorted by index
+    //Output: number of triangles of the halo
+    std::size_t tile_with_halo(int tile, std::vector<int> &triangles){
+        std::unordered_set<int> halo;
+        triangles.clear();
+        for(std::size_t i = tile_offsets[tile]; i < tile_offsets[tile+1]; i++)
+            triangles.push_back(tile_triangles[i]);
+        std::size_t n_tile = triangles.size();
+        for(std::size_t i = 0; i < triangles.size(); i++){
+            int t = triangles[i];
+            for(int k = 0; k < 3; k++){
+                int n = neighbor(t, k);
+                if(n == -1 || tile_of[n] == tile || halo.count(n) || !is_region_edge(t, k, n))
+                    continue;
+                halo.insert(n);
+                triangles.push_back(n);
+            }
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles.size() - n_tile;
+    }
+
+    //Triangulation of the triangles, sorted by index, with the vertices renumbered in the order of the input
+    //Output: vertices with the index in the input of each vertex of the triangulation
+    Triangulation *sub_triangulation(const std::vector<int> &triangles, std::vector<int> &vertices){
+        if(local_vertex == nullptr){
+            std::string pid = std::to_string(getpid());
+            local_vertex.reset(new file_array<int>(scratch + "/local_vertex." + pid));
+            local_triangle.reset(new file_array<int>(scratch + "/local_triangle." + pid));
+            local_vertex->assign(border.size(), -1);
+            local_triangle->assign(faces.size()/3, -1);
+        }
+        file_array<int> &local_vertex = *this->local_vertex, &local_triangle = *this->local_triangle;
+        vertices.clear();
+        for(std::size_t i = 0; i < triangles.size(); i++){
+            int t = triangles[i];
+            local_triangle[t] = i;
+            for(int k = 0; k < 3; k++){
+                int v = faces[3*t+k];
+                if(local_vertex[v] == -1){
+                    local_vertex[v] = 0;
+                    vertices.push_back(v);
+                }
+            }
+        }
+        std::sort(vertices.begin(), vertices.end());
+        std::vector<double> sub_points(2*vertices.size());
+        std::vector<char> sub_border(vertices.size());
+        for(std::size_t v = 0; v < vertices.size(); v++){
+            local_vertex[vertices[v]] = v;
+            sub_points[2*v] = points[2*vertices[v]];
+            sub_points[2*v+1] = points[2*vertices[v]+1];
+            sub_border[v] = border[vertices[v]];
+        }
+        std::vector<int> sub_faces(3*triangles.size()), sub_neighs(3*triangles.size());
+        for(std::size_t i = 0; i < triangles.size(); i++){
+            int t = triangles[i];
+            for(int k = 0; k < 3; k++){
+                sub_faces[3*i+k] = local_vertex[faces[3*t+k]];
+                int n = neighs[3*t+k];
+                sub_neighs[3*i+k] = n == -1 ? -1 : local_triangle[n];
+            }
+        }
+        //the indices are cleared for the next tile
+        for(int t : triangles)
+            local_triangle[t] = -1;
+        for(int v : vertices)
+            local_vertex[v] = -1;
+        return new Triangulation(sub_points, sub_border, sub_faces, sub_neighs);
+    }
+
+    int tile_of_triangle(int t) { return tile_of[t]; }
+};
+
+//Mesh a tile and write its polygons in b, with the vertices of the input
+//Output: number of polygons of the tile
+inline std::size_t mesh_tile(tiled_triangulation &tr, int tile, int n_threads, text_buffer &b, std::size_t &n_halo,
+        std::vector<int> &triangles, std::vector<int> &vertices){
+    n_halo += tr.tile_with_halo(tile, triangles);
+    if(triangles.empty())
+        return 0;
+    Triangulation *sub = tr.sub_triangulation(triangles, vertices);
+    null_buffer discarded;
+    std::streambuf *old = std::cout.rdbuf(&discarded);
+    PolyllaMesh<Triangulation> mesh(sub, n_threads);
+    std::cout.rdbuf(old);
+    const polygon_list &polygons = mesh.get_polygons();
+    std::size_t n_polygons = 0;
+    for(std::size_t i = 0; i < polygons.size(); i++){
+        if(tr.tile_of_triangle(triangles[polygons.seed(i)/3]) != tile)
+            continue;
+        b.put(polygons.size(i)).put(' ');
+        for(const int *v = polygons.begin(i); v != polygons.end(i); v++)
+            b.put(vertices[*v]).put(' ');
+        b.put('\n');
+        n_polygons++;
+    }
+    return n_polygons;
+}
+
+//Polygons of a tile in the polygon file of the process that meshed it
+struct tile_output {
+    int64_t process = -1;
+    int64_t offset = 0; //position of the polygons in the file
+    int64_t bytes = 0;
+    int64_t polygons = 0;
+    int64_t halo = 0; //triangles of the halo
+};
+
+//Mesh the tiles taken from next_tile until there are no tiles left, the polygons are appended to the file
+//polygons.<process> and each tile is recorded in outputs
+//Throw std::runtime_error if the polygon file can not be written
+inline void mesh_tiles(tiled_triangulation &tr, const std::string &scratch, int process, std::atomic<int> &next_tile,
+        file_array<tile_output> &outputs, int n_threads){
+    std::string polygons_name = scratch + "/polygons." + std::to_string(process);
+    output_file polygons_file(polygons_name);
+    if(!polygons_file.good())
+        throw std::runtime_error("unable to open the polygon file " + polygons_name);
+    text_buffer b;
+    std::vector<int> triangles, vertices;
+    int64_t offset = 0;
+    for(int tile = next_tile++; tile < tr.tiles(); tile = next_tile++){
+        std::size_t n_halo = 0;
+        std::size_t n_polygons = mesh_tile(tr, tile, n_threads, b, n_halo, triangles, vertices);
+        polygons_file.write(b);
+        outputs[tile] = {process, offset, (int64_t)b.size(), (int64_t)n_polygons, (int64_t)n_halo};
+        offset += b.size();
+        b.clear();
+    }
+    if(!polygons_file.close())
+        throw std::runtime_error("unable to write the polygon file " + polygons_name);
+}
+
+//Generate the Polylla mesh of the files tile by tile and write it in the OFF file output
+//With n_processes > 1 the tiles are meshed by worker processes forked after the partition: the scratch files
+//are shared by the processes, each worker takes the next tile from a counter in shared memory and appends its
+//polygons to its own file, and the coordinator merges the files in the order of the tiles, so the output is the
+//same of one process with the same tiles
+//Input: files of the triangulation, name of the OFF file, memory budget in bytes of all the processes, number of
+//       worker processes, threads of each tile
+//Throw std::runtime_error if a file can not be read or written, std::invalid_argument if the triangulation is not valid
+inline void generate(const std::string &node_file, const std::string &ele_file, const std::string &neigh_file,
+        const std::string &output, std::size_t memory_budget, int n_processes, int n_threads){
+    namespace fs = std::filesystem;
+    instrumentation &stats = instrumentation::get();
+    std::string scratch = output + ".tiles";
+    fs::create_directories(scratch);
+    //the scratch directory is removed at the end, after the scratch files of tr are closed, also after an error
+    struct scratch_guard {
+        std::string dir;
+        ~scratch_guard(){
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+        }
+    } guard{scratch};
+    n_processes = std::max(1, n_processes);
+    {
+        tiled_triangulation tr(scratch);
+        auto t_start = std::chrono::high_resolution_clock::now();
+        std::cout<<"Reading the triangulation in "<<scratch<<std::endl;
+        stats.begin("read_tiled_triangulation");
+        tr.read(node_file, ele_file, neigh_file, n_threads);
+        stats.end();
+        stats.count("triangles", tr.faces_count());
+        //each process has a tile in memory, and there are TILES_PER_PROCESS tiles per process to balance them
+        std::size_t max_tile_triangles = std::max<std::size_t>(1, memory_budget/(2*TRIANGLE_BYTES*n_processes));
+        if(n_processes > 1)
+            max_tile_triangles = std::min<std::size_t>(max_tile_triangles, tr.faces_count()/(TILES_PER_PROCESS*n_processes) + 1);
+        stats.begin("partition_tiles");
+        tr.partition(max_tile_triangles);
+        stats.end();
+        stats.count("tiles", tr.tiles());
+        auto t_end = std::chrono::high_resolution_clock::now();
+        std::cout<<"Partitioned "<<tr.faces_count()<<" triangles in "<<tr.tiles()<<" tiles of at most "<<max_tile_triangles<<" triangles in "<<std::chrono::duration<double, std::milli>(t_end-t_start).count()<<" ms"<<std::endl;
+
+        //the tile counter and the outputs of the tiles are shared by the processes
+        file_array<tile_output> outputs(scratch + "/tile_outputs");
+        outputs.assign(tr.tiles(), tile_output());
+        void *shared = mmap(nullptr, sizeof(std::atomic<int>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(shared == MAP_FAILED)
+            throw std::runtime_error("unable to map the shared memory of the tiles");
+        std::atomic<int> *next_tile = new(shared) std::atomic<int>(0);
+        t_start = std::chrono::high_resolution_clock::now();
+        stats.begin("mesh_tiles");
+        if(n_processes == 1){
+            mesh_tiles(tr, scratch, 0, *next_tile, outputs, n_threads);
+        }else{
+            std::cout.flush();
+            std::vector<pid_t> workers;
+            for(int p = 0; p < n_processes; p++){
+                pid_t pid = fork();
+                if(pid == 0){
+                    //the worker ends without destructors, the scratch files are removed by the coordinator
+                    //an error ends the worker with status 1, so the coordinator fails
+                    try{
+                        mesh_tiles(tr, scratch, p, *next_tile, outputs, n_threads);
+                    }catch(const std::exception &e){
+                        std::cout<<"Error: "<<e.what()<<std::endl;
+                        _exit(1);
+                    }
+                    _exit(0);
+                }
+                if(pid < 0){
+                    //the workers already created are waited before the error is thrown, they use the scratch files
+                    for(pid_t worker : workers)
+                        waitpid(worker, nullptr, 0);
+                    throw std::runtime_error("unable to create the worker process " + std::to_string(p));
+                }
+                workers.push_back(pid);
+            }
+            bool failed = false;
+            for(pid_t pid : workers){
+                int status;
+                waitpid(pid, &status, 0);
+                failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+            }
+            if(failed)
+                throw std::runtime_error("a worker process failed, the tiles were not meshed");
+        }
+        munmap(shared, sizeof(std::atomic<int>));
+        stats.end();
+        std::size_t n_polygons = 0, n_halo = 0;
+        for(int tile = 0; tile < tr.tiles(); tile++){
+            n_polygons += outputs[tile].polygons;
+            n_halo += outputs[tile].halo;
+        }
+        stats.count("halo_triangles", n_halo);
+        stats.count("polygons", n_polygons);
+        t_end = std::chrono::high_resolution_clock::now();
+        std::cout<<"Meshed the tiles with "<<n_processes<<" processes and "<<n_halo<<" triangles in the halos in "<<std::chrono::duration<double, std::milli>(t_end-t_start).count()<<" ms"<<std::endl;
+        std::cout<<"Mesh with "<<n_polygons<<" polygons"<<std::endl;
+
+        //OFF file with the same format of PolyllaMesh::print_OFF, the polygons of the tiles in order
+        stats.begin("write_off");
+        output_file out(output);
+        text_buffer b;
+        b.put("{ appearance  {+edge +face linewidth 2} LIST\n");
+        b.put("OFF\n");
+        b.put(tr.vertices()).put(' ').put(n_polygons).put(" 0\n");
+        out.write(b);
+        write_parallel(out, tr.vertices(), n_threads, [&](text_buffer &b, std::size_t v){
+            b.put(tr.get_PointX(v), 15).put(' ').put(tr.get_PointY(v), 15).put(" 0\n");
+        });
+        {
+            std::vector<std::unique_ptr<mapped_file>> polygons_text(n_processes);
+            for(int p = 0; p < n_processes; p++)
+                polygons_text[p].reset(new mapped_file(scratch + "/polygons." + std::to_string(p)));
+            for(int tile = 0; tile < tr.tiles(); tile++){
+                const tile_output &o = outputs[tile];
+                if(o.bytes > 0)
+                    out.write(polygons_text[o.process]->begin() + o.offset, o.bytes);
+            }
+        }
+        b.clear();
+        b.put("}\n");
+        out.write(b);
+        if(!out.close())
+            throw std::runtime_error("unable to write the OFF file " + output);
+        stats.end();
+        stats.count("polygons", n_polygons);
+    }
+}
+}
+
+#endif
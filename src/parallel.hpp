@@ -0,0 +1,106 @@
+/* Minimal thread helpers shared by the parallel phases of Polylla
+    resolve_threads(n): number of threads to use, n < 1 means all the hardware threads
+    parallel_for_blocks(begin, end, n_threads, f): split [begin, end) in n_threads contiguous blocks
+        and call f(thread_id, block_begin, block_end) for each block in its own thread
+    block_begin(n, n_threads, thread_id): first index of the block assigned to a thread
+    parallel_for_stealing(begin, end, n_threads, f): call f(thread_id, i) for each i in [begin, end), for tasks
+        of different cost, a thread that ends its block takes the last indices of the blocks of the other threads
+*/
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <mutex>
+#include <memory>
+
+//Input: number of threads requested
+//Output: number of threads to use, if n < 1 the number of hardware threads is used
+inline int resolve_threads(int n){
+    if(n >= 1)
+        return n;
+    int hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+//Input: size of the range n, number of blocks and index of the block
+//Output: first index of the block, block i is [block_begin(n,t,i), block_begin(n,t,i+1))
+inline std::size_t block_begin(std::size_t n, int n_threads, int thread_id){
+    return (n / n_threads) * thread_id + std::min<std::size_t>(thread_id, n % n_threads);
+}
+
+//Split the range [begin, end) in n_threads contiguous blocks, block i is always processed by thread i
+//and blocks are ordered, so the results of each thread can be merged in the same order of the serial loop
+//With one thread the function is called in the current thread without spawning anything
+template <typename Function>
+void parallel_for_blocks(std::size_t begin, std::size_t end, int n_threads, Function f){
+    std::size_t n = end > begin ? end - begin : 0;
+    if(n_threads <= 1 || n < 2){
+        f(0, begin, end);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(n_threads - 1);
+    for(int t = 1; t < n_threads; t++)
+        workers.emplace_back(f, t, begin + block_begin(n, n_threads, t), begin + block_begin(n, n_threads, t + 1));
+    f(0, begin, begin + block_begin(n, n_threads, 1));
+    for(auto &w : workers)
+        w.join();
+}
+
+//Block of indices of a thread in parallel_for_stealing, the owner takes the first index and the
+//other threads take the last one
+struct stealing_block {
+    std::mutex lock;
+    std::size_t begin = 0, end = 0;
+
+    //Input: true to take the first index, false to take the last one
+    //Output: true if an index was taken, the index is stored in i
+    bool take(bool first, std::size_t &i){
+        std::lock_guard<std::mutex> guard(lock);
+        if(begin >= end)
+            return false;
+        i = first ? begin++ : --end;
+        return true;
+    }
+};
+
+//Call f(thread_id, i) for each i in [begin, end) with n_threads threads
+//Each thread starts with the contiguous block of parallel_for_blocks and, when it is empty, steals the last
+//index of the next thread with indices left, so tasks of very different cost are balanced
+//The order of the calls is not defined, f must not depend on it
+template <typename Function>
+void parallel_for_stealing(std::size_t begin, std::size_t end, int n_threads, Function f){
+    std::size_t n = end > begin ? end - begin : 0;
+    if(n_threads <= 1 || n < 2){
+        for(std::size_t i = begin; i < end; i++)
+            f(0, i);
+        return;
+    }
+    std::unique_ptr<stealing_block[]> blocks(new stealing_block[n_threads]);
+    for(int t = 0; t < n_threads; t++){
+        blocks[t].begin = begin + block_begin(n, n_threads, t);
+        blocks[t].end = begin + block_begin(n, n_threads, t + 1);
+    }
+    auto worker = [&](int id){
+        std::size_t i;
+        while(blocks[id].take(true, i))
+            f(id, i);
+        for(int k = 1; k < n_threads; k++){
+            stealing_block &victim = blocks[(id + k) % n_threads];
+            while(victim.take(false, i))
+                f(id, i);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(n_threads - 1);
+    for(int t = 1; t < n_threads; t++)
+        workers.emplace_back(worker, t);
+    worker(0);
+    for(auto &w : workers)
+        w.join();
+}
+
+#endif
@@ -0,0 +1,139 @@
+/* Polygons of a Polylla mesh stored in compressed sparse row (CSR) format
+    offsets: the vertices of the polygon i are vertices[offsets[i] .. offsets[i+1]], offsets[0] = 0
+    vertices: vertices of all the polygons, one polygon after the other
+    seeds: seed edge that generated each polygon
+    The polygons are in three arrays, so adding a polygon does not allocate memory for it and the polygons
+    are read in order without following pointers.
+    A polygon can be erased without moving the others, its seed is set to -1 and it is skipped by the writers
+    until the list is compacted.
+*/
+
+#ifndef POLYGON_LIST_HPP
+#define POLYGON_LIST_HPP
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <mesh_array.hpp>
+
+class polygon_list
+{
+private:
+    std::vector<int> offsets = {0};
+    std::vector<int> vertices;
+    std::vector<int> seeds;
+    std::size_t erased = 0; //number of erased polygons
+
+public:
+    //Number of polygons, including the erased polygons
+    std::size_t size() const { return seeds.size(); }
+
+    //Number of erased polygons
+    std::size_t n_erased() const { return erased; }
+
+    //Number of vertices of all the polygons
+    std::size_t n_vertices() const { return vertices.size(); }
+
+    void clear(){
+        offsets.assign(1, 0);
+        vertices.clear();
+        seeds.clear();
+        erased = 0;
+    }
+
+    void reserve(std::size_t n_polygons, std::size_t n_polygon_vertices){
+        offsets.reserve(n_polygons + 1);
+        seeds.reserve(n_polygons);
+        vertices.reserve(n_polygon_vertices);
+    }
+
+    //Exchange the polygons and the memory of two lists
+    void swap(polygon_list &other){
+        offsets.swap(other.offsets);
+        vertices.swap(other.vertices);
+        seeds.swap(other.seeds);
+        std::swap(erased, other.erased);
+    }
+
+    //Add a polygon with the vertices [begin, end) generated by the seed edge seed
+    template <typename Iterator>
+    void push_back(int seed, Iterator begin, Iterator end){
+        vertices.insert(vertices.end(), begin, end);
+        offsets.push_back(vertices.size());
+        seeds.push_back(seed);
+    }
+
+    //Add the polygons of other after the polygons of this list
+    void append(const polygon_list &other){
+        int shift = vertices.size();
+        vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
+        for(std::size_t i = 1; i < other.offsets.size(); i++)
+            offsets.push_back(other.offsets[i] + shift);
+        seeds.insert(seeds.end(), other.seeds.begin(), other.seeds.end());
+        erased += other.erased;
+    }
+
+    //Erase the polygon i, the index of the other polygons does not change
+    void erase(std::size_t i){
+        if(seeds.at(i) != -1){
+            seeds[i] = -1;
+            erased++;
+        }
+    }
+
+    bool is_erased(std::size_t i) const { return seeds.at(i) == -1; }
+
+    //Remove the erased polygons, the polygons after them are moved to lower indices
+    void compact(){
+        if(erased == 0)
+            return;
+        std::size_t n = 0, n_vertices = 0;
+        for(std::size_t i = 0; i < seeds.size(); i++){
+            if(seeds[i] == -1)
+                continue;
+            int begin = offsets[i], end = offsets[i+1];
+            std::copy(vertices.begin() + begin, vertices.begin() + end, vertices.begin() + n_vertices);
+            n_vertices += end - begin;
+            seeds[n] = seeds[i];
+            offsets[n+1] = n_vertices;
+            n++;
+        }
+        seeds.resize(n);
+        offsets.resize(n + 1);
+        vertices.resize(n_vertices);
+        erased = 0;
+    }
+
+    //Seed edge of the polygon i
+    int seed(std::size_t i) const { return seeds.at(i); }
+
+    //Number of vertices of the polygon i
+    int size(std::size_t i) const { return offsets.at(i+1) - offsets.at(i); }
+
+    //Vertices of the polygon i
+    const int *begin(std::size_t i) const { return vertices.data() + offsets.at(i); }
+    const int *end(std::size_t i) const { return vertices.data() + offsets.at(i+1); }
+
+    //Vertices of the polygon i as a view of the list, valid until the list is changed
+    mesh_span<const int> polygon(std::size_t i) const { return mesh_span<const int>(begin(i), size(i)); }
+
+    //Arrays of the CSR format, used to write the polygons in a binary file
+    const std::vector<int> &get_offsets() const { return offsets; }
+    const std::vector<int> &get_vertices() const { return vertices; }
+    const std::vector<int> &get_seeds() const { return seeds; }
+
+    //Set the polygons from the arrays of the CSR format
+    void assign(const int *offsets_begin, std::size_t n_polygons, const int *vertices_begin, const int *seeds_begin){
+        offsets.assign(offsets_begin, offsets_begin + n_polygons + 1);
+        vertices.assign(vertices_begin, vertices_begin + offsets.back());
+        seeds.assign(seeds_begin, seeds_begin + n_polygons);
+        erased = std::count(seeds.begin(), seeds.end(), -1);
+    }
+
+    //Bytes used by the polygons
+    std::size_t bytes() const {
+        return (offsets.capacity() + vertices.capacity() + seeds.capacity())*sizeof(int);
+    }
+};
+
+#endif
@@ -0,0 +1,157 @@
+/* Streaming output of a Polylla mesh: the OFF and ALE files are written while the polygons are generated
+    The text is formatted by the threads of the mesh in chunks, each chunk has a part of the OFF file and the same
+    part of the ALE file. The chunks are given to a writer thread in the order of the files with push, so the
+    writing of a chunk overlaps the formatting of the next ones. The queue holds at most max_queued chunks, push
+    waits while it is full, and the chunks written are reused by acquire, so the memory of the output is bounded
+    by the size of the chunks and does not depend on the number of polygons.
+
+    The number of polygons is written in the headers before it is known: reserve_count writes COUNT_WIDTH spaces
+    and close writes the number over them when the last chunk is written, so the number is followed by spaces.
+*/
+
+#ifndef POLYGON_STREAM_HPP
+#define POLYGON_STREAM_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <charconv>
+#include <mesh_writer.hpp>
+
+class polygon_stream
+{
+public:
+    //Part of the OFF file and the same part of the ALE file
+    struct chunk {
+        text_buffer off;
+        text_buffer ale;
+    };
+
+    //Characters reserved for the number of polygons in the headers, the number of digits of the largest int
+    static const int COUNT_WIDTH = 10;
+
+private:
+    output_file off_file;
+    output_file ale_file;
+    std::size_t max_queued;
+
+    std::vector<std::unique_ptr<chunk>> chunks; //every chunk allocated, they are reused
+    std::deque<chunk *> queued; //chunks to write, nullptr after the last one
+    std::vector<chunk *> free_chunks; //chunks already written
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread writer;
+    bool closed = false;
+
+    //Characters of each file given with push, the offsets of the numbers of polygons in the files
+    std::size_t off_pushed = 0, ale_pushed = 0;
+    std::size_t off_count = 0, ale_count = 0;
+
+    //Write the queued chunks until the end of the queue
+    void write_chunks(){
+        while(true){
+            chunk *c;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&]{ return !queued.empty(); });
+                c = queued.front();
+                queued.pop_front();
+            }
+            changed.notify_all();
+            if(c == nullptr)
+                return;
+            off_file.write(c->off);
+            ale_file.write(c->ale);
+            c->off.clear();
+            c->ale.clear();
+            std::lock_guard<std::mutex> guard(lock);
+            free_chunks.push_back(c);
+        }
+    }
+
+    void write_count(output_file &file, std::size_t offset, long long n_polygons){
+        char tmp[COUNT_WIDTH + 16];
+        auto result = std::to_chars(tmp, tmp + sizeof(tmp), n_polygons);
+        file.write_at(tmp, result.ptr - tmp, offset);
+    }
+
+public:
+    //Open the output files and start the writer thread, push waits while max_queued chunks are not written
+    polygon_stream(const std::string &off_name, const std::string &ale_name, std::size_t max_queued = 4)
+        : off_file(off_name), ale_file(ale_name), max_queued(max_queued < 1 ? 1 : max_queued) {
+        writer = std::thread(&polygon_stream::write_chunks, this);
+    }
+
+    polygon_stream(const polygon_stream&) = delete;
+    polygon_stream& operator=(const polygon_stream&) = delete;
+
+    ~polygon_stream(){
+        close(-1);
+    }
+
+    //Return an empty chunk, a chunk already written or a new one
+    chunk *acquire(){
+        std::lock_guard<std::mutex> guard(lock);
+        if(!free_chunks.empty()){
+            chunk *c = free_chunks.back();
+            free_chunks.pop_back();
+            return c;
+        }
+        chunks.push_back(std::make_unique<chunk>());
+        return chunks.back().get();
+    }
+
+    //Give a chunk to the writer thread after the chunks given before, wait while the queue is full
+    void push(chunk *c){
+        off_pushed += c->off.size();
+        ale_pushed += c->ale.size();
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&]{ return queued.size() < max_queued; });
+            queued.push_back(c);
+        }
+        changed.notify_all();
+    }
+
+    //Reserve the number of polygons at the end of the text of c in the OFF file or in the ALE file
+    void reserve_off_count(chunk &c){
+        off_count = off_pushed + c.off.size();
+        c.off.put(std::string(COUNT_WIDTH, ' '));
+    }
+
+    void reserve_ale_count(chunk &c){
+        ale_count = ale_pushed + c.ale.size();
+        c.ale.put(std::string(COUNT_WIDTH, ' '));
+    }
+
+    //True if both files were opened and every chunk was written
+    bool good() const { return off_file.good() && ale_file.good(); }
+
+    //Wait until every chunk is written, write the number of polygons in the headers and close the files
+    //A negative number leaves the reserved spaces
+    //Return false if a file could not be written
+    bool close(long long n_polygons){
+        if(closed)
+            return good();
+        closed = true;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            queued.push_back(nullptr);
+        }
+        changed.notify_all();
+        writer.join();
+        if(n_polygons >= 0){
+            write_count(off_file, off_count, n_polygons);
+            write_count(ale_file, ale_count, n_polygons);
+        }
+        bool off_written = off_file.close();
+        bool ale_written = ale_file.close();
+        return off_written && ale_written;
+    }
+};
+
+#endif
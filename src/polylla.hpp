@@ -13,66 +13,177 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <stdexcept>
 #include <triangulation.hpp>
+#include <parallel.hpp>
+#include <mesh_writer.hpp>
+#include <instrumentation.hpp>
+#include <polygon_list.hpp>
+#include <polygon_stream.hpp>
+#include <edge_set.hpp>
+#include <predicates.hpp>
+#include <max_edge_kernel.hpp>
+#include <delaunay.hpp>
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
+#include <iterator>
 
 #define print_e(eddddge) eddddge<<" ( "<<tr->origin(eddddge)<<" - "<<tr->target(eddddge)<<") "
 
-struct Polygon{
-    int seed_edge; //Edge that generate the polygon
-    std::vector<int> vertices; //Vertices of the polygon
-    //std::vector<int> neighbors; //Neighbors of the polygon WIP
-};
-
-class Polylla
+//Polylla mesh generated from a triangulation of type Mesh, Mesh must have the accessors of Triangulation
+//(next, prev, twin, origin, target, CW_edge_to_vertex, is_border_face, ...)
+template <typename Mesh>
+class PolyllaMesh
 {
-private:
+protected: //the phases are protected so they can be measured separately by the benchmarks
     typedef std::vector<int> _polygon; 
     typedef std::vector<char> bit_vector; 
 
+    //Buffers of a thread in the travel phase, they keep their capacity between seed edges,
+    //so traveling and repairing a polygon does not allocate memory once they have grown
+    struct travel_buffers {
+        _polygon poly; //polygon traveled from a seed edge
+        _polygon repaired; //polygon generated by the reparation
+        std::vector<int> repair_seeds; //seed edges added by the reparation
+        edge_set repair_marks; //seed edges of the reparation that have not generated a polygon
+        polygon_list polygons; //polygons generated by the thread
+        int n_barrier_edge_tips = 0; //barrier-edge tips repaired by the thread
+    };
 
-    Triangulation *tr; // Halfedge triangulation
-    std::vector<Polygon> polygonal_mesh; //Vector of polygons generated by polygon
-    std::vector<int> triangles; //True if the edge generated a triangle CHANGE!!!!
+    Mesh *tr = nullptr; // Halfedge triangulation
+    polygon_list polygonal_mesh; //Polygons of the mesh in CSR format
 
     bit_vector max_edges; //True if the edge i is a max edge
     bit_vector frontier_edges; //True if the edge i is a frontier edge
     bit_vector terminal_edges; //True if the edge i is a terminal edge
+    bit_vector constrained_edges; //True if the edge i is a constrained frontier edge, empty if there are none
     std::vector<int> seed_edges; //Seed edges that generate polygon simple and non-simple
 
     int m_polygons = 0; //Number of polygons
     int n_frontier_edges = 0; //Number of frontier edges
     int n_barrier_edge_tips = 0; //Number of barrier edge tips
+    int n_threads = 1; //Number of threads used in the label and travel phases
+    std::vector<travel_buffers> buffers; //Buffers of each thread in the travel phase
+    polygon_stream *stream = nullptr; //Output of the streaming mode, the polygons are written to it instead of stored
+
+    //Polygon adjacency in CSR format, the neighbors of the polygon i are adjacency[adjacency_offsets[i] .. adjacency_offsets[i+1]]
+    //adjacency_offsets is empty if the polygons changed since it was built
+    std::vector<int> adjacency_offsets;
+    std::vector<int> adjacency;
+
+    //State of the local updates, built by the first update
+    std::vector<int> face_polygon; //Index in polygonal_mesh of the polygon of each face
+    bit_vector in_region; //Non zero if the face is in the region of the update, OLD_LABELS or NEW_LABELS
+    std::vector<int> region; //Faces of the region of the update
+    std::vector<int> region_seeds; //Seed edges of the region of the update
+    std::vector<int> face_stack; //Faces to visit when the polygon of a face is set
+    bool seed_edges_outdated = false; //True if seed_edges has not been updated after a local update
 public:
 
-    Polylla() {}; //Default constructor
+    PolyllaMesh() {}; //Default constructor
 
-    //Constructor from a OFF file
-    Polylla(std::string off_file){
+    //Constructor from a OFF file, a binary mesh file or a .node file, the points of a .node file are triangulated
+    //n_threads < 1 uses all the hardware threads
+    //With a stream the OFF and ALE files are written while the polygons are generated and the polygons are not
+    //stored, so the mesh can not be printed or updated after
+    PolyllaMesh(std::string off_file, int n_threads = 1, polygon_stream *stream = nullptr){
+        this->n_threads = resolve_threads(n_threads);
+        this->stream = stream;
+        if(mesh_binary::is_binary_file(off_file)){
+            load_binary(off_file);
+            return;
+        }
+        if(off_file.size() > 5 && off_file.compare(off_file.size() - 5, 5, ".node") == 0){
+            std::vector<double> points;
+            std::vector<char> markers;
+            std::cout<<"Reading node file"<<std::endl;
+            instrumentation::get().begin("read_node_file");
+            int base = mesh_reader::read_node_file(off_file, points, markers, this->n_threads);
+            instrumentation::get().end();
+            if(base == -1)
+                throw std::runtime_error("unable to read the node file " + off_file);
+            triangulate_points(points);
+            construct_Polylla();
+            return;
+        }
         //std::cout<<"Generating Triangulization..."<<std::endl;
+        instrumentation &stats = instrumentation::get();
+        stats.begin("triangulation");
         auto t_start = std::chrono::high_resolution_clock::now();
-        this->tr = new Triangulation(off_file);
+        this->tr = new Mesh(off_file, this->n_threads);
         auto t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        count_triangulation();
         double elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
         std::cout<<"Triangulation generated "<<elapsed_time_ms<<" ms"<<std::endl;
 
         construct_Polylla();
     }
 
-    //Constructor from a node_file, ele_file and neigh_file
-    Polylla(std::string node_file, std::string ele_file, std::string neigh_file){
+    //Constructor from a node_file, ele_file and neigh_file, the stream is used as in the constructor from a OFF file
+    PolyllaMesh(std::string node_file, std::string ele_file, std::string neigh_file, int n_threads = 1, polygon_stream *stream = nullptr){
+        this->n_threads = resolve_threads(n_threads);
+        this->stream = stream;
         //std::cout<<"Generating Triangulization..."<<std::endl;
+        instrumentation &stats = instrumentation::get();
+        stats.begin("triangulation");
         auto t_start = std::chrono::high_resolution_clock::now();
-        this->tr = new Triangulation(node_file, ele_file, neigh_file);
+        this->tr = new Mesh(node_file, ele_file, neigh_file, this->n_threads);
         auto t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        count_triangulation();
         double elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
         std::cout<<"Triangulation generated "<<elapsed_time_ms<<" ms"<<std::endl;
 
         construct_Polylla();
     }
 
-    ~Polylla() {
+    //Constructor from points x0 y0 x1 y1 ..., the mesh is generated from their Delaunay triangulation
+    //The repeated points are removed, so the vertices of the mesh are the different points in the input order
+    //Throw std::runtime_error if the points have no triangulation (less than 3 different points, all collinear or too many)
+    PolyllaMesh(std::vector<double> points, int n_threads = 1){
+        this->n_threads = resolve_threads(n_threads);
+        triangulate_points(points);
+        construct_Polylla();
+    }
+
+    //Constructor from arrays in memory, with the arrays of the constructor of Mesh from mesh_span
+    //Input: x and y of each vertex, three vertices of each triangle counterclockwise, neighbors of each triangle
+    //       as in the .neigh file or empty
+    //The arrays are only read, the triangulation copies them to its own layout
+    //Throw std::invalid_argument if the arrays are not a valid triangulation
+    PolyllaMesh(mesh_span<const double> x, mesh_span<const double> y, mesh_span<const int> triangles, mesh_span<const int> neighs = {}, int n_threads = 1){
+        this->n_threads = resolve_threads(n_threads);
+        instrumentation &stats = instrumentation::get();
+        stats.begin("triangulation");
+        this->tr = new Mesh(x, y, triangles, neighs, this->n_threads);
+        stats.end();
+        count_triangulation();
+        construct_Polylla();
+    }
+
+    //Constructor from arrays in memory used in place, only for CompactTriangulation
+    //x, y and triangles are not copied, they must outlive the mesh and move_vertices writes the new coordinates in x and y
+    PolyllaMesh(mesh_in_place_t, mesh_span<double> x, mesh_span<double> y, mesh_span<int> triangles, mesh_span<const int> neighs = {}, int n_threads = 1){
+        this->n_threads = resolve_threads(n_threads);
+        instrumentation &stats = instrumentation::get();
+        stats.begin("triangulation");
+        this->tr = new Mesh(mesh_in_place, x, y, triangles, neighs, this->n_threads);
+        stats.end();
+        count_triangulation();
+        construct_Polylla();
+    }
+
+    //Constructor from a triangulation, the mesh deletes it
+    PolyllaMesh(Mesh *tr, int n_threads = 1){
+        this->n_threads = resolve_threads(n_threads);
+        this->tr = tr;
+        count_triangulation();
+        construct_Polylla();
+    }
+
+    ~PolyllaMesh() {
         delete tr;
     }
 
@@ -81,56 +192,60 @@ public:
         frontier_edges = bit_vector(tr->halfEdges(), false);
         terminal_edges = bit_vector(tr->halfEdges(), false);
         //seed_edges = bit_vector(tr->halfEdges(), false);
-        triangles = tr->get_Triangles(); //Change by triangle list
+        //the writer thread writes the vertices while the edges are labeled
+        if(stream)
+            stream_vertices();
 
         //Label max edges of each triangle
-        //for (size_t t = 0; t < tr->faces(); t++){
+        instrumentation &stats = instrumentation::get();
+        stats.begin("label_max_edges");
         auto t_start = std::chrono::high_resolution_clock::now();
-        for(auto &t : triangles)
-            max_edges[label_max_edge(t)] = true;   
+        label_max_edges();
         auto t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        stats.count("triangles", tr->faces());
         double elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
-        std::cout<<"Labered max edges in "<<elapsed_time_ms<<" ms"<<std::endl;
+        std::cout<<"Labered max edges in "<<elapsed_time_ms<<" ms with "<<n_threads<<" threads"<<std::endl;
 
+        stats.begin("label_frontier_edges");
         t_start = std::chrono::high_resolution_clock::now();
         //Label frontier edges
-        for (std::size_t e = 0; e < tr->halfEdges(); e++){
-            if(is_frontier_edge(e)){
-                frontier_edges[e] = true;
-                n_frontier_edges++;
-            }
-        }
+        label_frontier_edges();
         t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        stats.count("frontier_edges", n_frontier_edges);
         elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
-        std::cout<<"Labeled frontier edges in "<<elapsed_time_ms<<" ms"<<std::endl;
+        std::cout<<"Labeled frontier edges in "<<elapsed_time_ms<<" ms with "<<n_threads<<" threads"<<std::endl;
         
+        stats.begin("label_seed_edges");
         t_start = std::chrono::high_resolution_clock::now();
         //label seeds edges,
-        for (std::size_t e = 0; e < tr->halfEdges(); e++)
-            if(tr->is_interior_face(e) && is_seed_edge(e))
-                seed_edges.push_back(e);
+        label_seed_edges();
         t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        stats.count("seed_edges", seed_edges.size());
         elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
-        std::cout<<"Labeled seed edges in "<<elapsed_time_ms<<" ms"<<std::endl;
+        std::cout<<"Labeled seed edges in "<<elapsed_time_ms<<" ms with "<<n_threads<<" threads"<<std::endl;
 
 
         //Travel phase: Generate polygon mesh
-        _polygon poly;
-        //Foreach seed edge generate polygon
+        stats.begin("travel");
         t_start = std::chrono::high_resolution_clock::now();
-        for(auto &e : seed_edges){
-            poly = travel_triangles(e);
-            if(!has_BarrierEdgeTip(poly)){ //If the polygon is a simple polygon then is part of the mesh
-                polygonal_mesh.push_back({e, poly});
-            }else{ //Else, the polygon is send to reparation phase
-                barrieredge_tip_reparation(e, poly);
-            }         
-        }    
+        if(stream)
+            stream_travel_phase();
+        else
+            travel_phase();
         t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        if(!stream)
+            this->m_polygons = polygonal_mesh.size();
+        stats.count("polygons", m_polygons);
+        stats.count("barrier_edge_tips", n_barrier_edge_tips);
+        stats.count("polygon_bytes", polygonal_mesh.bytes());
         elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
-        std::cout<<"Polygons generated/repaired in "<<elapsed_time_ms<<" ms"<<std::endl;
-        
-        this->m_polygons = polygonal_mesh.size();
+        std::cout<<"Polygons generated/repaired in "<<elapsed_time_ms<<" ms with "<<n_threads<<" threads"<<std::endl;
+        if(stream)
+            stream_end();
 
         std::cout<<"Mesh with "<<m_polygons<<" polygons "<<n_frontier_edges/2<<" edges and "<<n_barrier_edge_tips<<" barrier-edge tips."<<std::endl;
         //tr->print_pg(std::to_string(tr->vertices()) + ".pg");             
@@ -146,27 +261,419 @@ public:
     }
 
     //Print ale file of the polylla mesh
-    void print_ALE(std::string filename){
-        std::ofstream out(filename);
-        _polygon poly;
-        out<<"# domain type\nCustom\n";
-        out<<"# nodal coordinates: number of nodes followed by the coordinates \n";
-        out<<tr->vertices()<<std::endl;
+    //Vertices and polygons are formatted in parallel in large buffers
+    //Return false if the file could not be written
+    bool print_ALE(std::string filename){
+        instrumentation::get().begin("write_ale");
+        output_file out(filename);
+        text_buffer head;
+        head.put("# domain type\nCustom\n");
+        head.put("# nodal coordinates: number of nodes followed by the coordinates \n");
+        head.put(tr->vertices()).put('\n');
+        out.write(head);
+        //print nodes
+        write_parallel(out, tr->vertices(), n_threads, [&](text_buffer &b, std::size_t v){
+            b.put(tr->get_PointX(v), 15).put(' ').put(tr->get_PointY(v), 15).put('\n');
+        });
+        head.clear();
+        head.put("# element connectivity: number of elements followed by the elements\n");
+        head.put(this->m_polygons).put('\n');
+        out.write(head);
+        //print polygons
+        write_parallel(out, polygonal_mesh.size(), n_threads, [&](text_buffer &b, std::size_t i){
+            if(polygonal_mesh.is_erased(i))
+                return;
+            b.put(polygonal_mesh.size(i)).put(' ');
+            for(const int *v = polygonal_mesh.begin(i); v != polygonal_mesh.end(i); v++)
+                b.put(*v + 1).put(' ');
+            b.put('\n');
+        });
+        text_buffer tail;
+        put_ALE_tail(tail);
+        out.write(tail);
+        bool written = out.close();
+        instrumentation::get().end();
+        instrumentation::get().count("polygons", m_polygons);
+        return written;
+    }
+
+    //Print off file of the polylla mesh
+    //Vertices and polygons are formatted in parallel in large buffers
+    //Return false if the file could not be written
+    bool print_OFF(std::string filename){
+        instrumentation::get().begin("write_off");
+        output_file out(filename);
+        text_buffer head;
+        head.put("{ appearance  {+edge +face linewidth 2} LIST\n");
+        head.put("OFF\n");
+        //num_vertices num_polygons 0
+        head.put(tr->vertices()).put(' ').put(m_polygons).put(" 0\n");
+        out.write(head);
         //print nodes
-        for(std::size_t v = 0; v < tr->vertices(); v++)
-            out<<std::setprecision(15)<<tr->get_PointX(v)<<" "<<tr->get_PointY(v)<<std::endl; 
-        out<<"# element connectivity: number of elements followed by the elements\n";
-        out<<this->m_polygons<<std::endl;
+        write_parallel(out, tr->vertices(), n_threads, [&](text_buffer &b, std::size_t v){
+            b.put(tr->get_PointX(v), 15).put(' ').put(tr->get_PointY(v), 15).put(" 0\n");
+        });
         //print polygons
-        for(auto &i : this->polygonal_mesh){
-            out<<i.vertices.size()<<" ";
-            for(auto &v : i.vertices){
-                out<<v + 1<<" ";
+        write_parallel(out, polygonal_mesh.size(), n_threads, [&](text_buffer &b, std::size_t i){
+            if(polygonal_mesh.is_erased(i))
+                return;
+            b.put(polygonal_mesh.size(i)).put(' ');
+            for(const int *v = polygonal_mesh.begin(i); v != polygonal_mesh.end(i); v++)
+                b.put(*v).put(' ');
+            b.put('\n');
+        });
+        head.clear();
+        head.put("}\n");
+        out.write(head);
+        bool written = out.close();
+        instrumentation::get().end();
+        instrumentation::get().count("polygons", m_polygons);
+        return written;
+    }
+
+    //Print the polygon adjacency, the number of polygons and a line for each polygon with the number of its
+    //neighbors and the neighbors, the polygons are numbered from 0 in the order of the .off file
+    //Return false if the file could not be written
+    bool print_adjacency(std::string filename){
+        build_polygon_adjacency();
+        instrumentation::get().begin("write_adjacency");
+        //index of each polygon in the output, the erased polygons are not written
+        std::vector<int> output_index;
+        if(polygonal_mesh.n_erased() > 0){
+            output_index.assign(polygonal_mesh.size(), -1);
+            int n = 0;
+            for(std::size_t i = 0; i < polygonal_mesh.size(); i++)
+                if(!polygonal_mesh.is_erased(i))
+                    output_index[i] = n++;
+        }
+        output_file out(filename);
+        text_buffer head;
+        head.put(m_polygons).put('\n');
+        out.write(head);
+        write_parallel(out, polygonal_mesh.size(), n_threads, [&](text_buffer &b, std::size_t i){
+            if(polygonal_mesh.is_erased(i))
+                return;
+            b.put(adjacency_offsets[i+1] - adjacency_offsets[i]);
+            for(int k = adjacency_offsets[i]; k < adjacency_offsets[i+1]; k++)
+                b.put(' ').put(output_index.empty() ? adjacency[k] : output_index[adjacency[k]]);
+            b.put('\n');
+        });
+        bool written = out.close();
+        instrumentation::get().end();
+        return written;
+    }
+
+    //Print a binary mesh file with the triangulation, the labels and the polygons of the mesh
+    //The file can be loaded again with the constructor from a file without generating the mesh
+    //Return false if the file could not be written
+    bool print_binary(std::string filename){
+        instrumentation::get().begin("write_binary");
+        //the file has the polygons and the seed edges of the current labels
+        if(seed_edges_outdated){
+            polygonal_mesh.compact();
+            face_polygon.clear();
+            adjacency_offsets.clear();
+            label_seed_edges();
+            seed_edges_outdated = false;
+        }
+        mesh_binary::writer out(sizeof(vertex), sizeof(halfEdge));
+        tr->add_to_binary(out);
+        const std::vector<int> &offsets = polygonal_mesh.get_offsets();
+        const std::vector<int> &vertices = polygonal_mesh.get_vertices();
+        const std::vector<int> &seeds = polygonal_mesh.get_seeds();
+        mesh_binary::header &h = out.get_header();
+        h.n_polygons = m_polygons;
+        h.n_frontier_edges = n_frontier_edges;
+        h.n_barrier_edge_tips = n_barrier_edge_tips;
+        out.add_section(mesh_binary::MAX_EDGES, max_edges.data(), max_edges.size());
+        out.add_section(mesh_binary::FRONTIER_EDGES, frontier_edges.data(), frontier_edges.size());
+        out.add_section(mesh_binary::SEED_EDGES, seed_edges.data(), seed_edges.size()*sizeof(int));
+        out.add_section(mesh_binary::POLYGON_OFFSETS, offsets.data(), offsets.size()*sizeof(int));
+        out.add_section(mesh_binary::POLYGON_VERTICES, vertices.data(), vertices.size()*sizeof(int));
+        out.add_section(mesh_binary::POLYGON_SEEDS, seeds.data(), seeds.size()*sizeof(int));
+        bool written = out.write(filename);
+        instrumentation::get().end();
+        instrumentation::get().count("polygons", m_polygons);
+        if(!written)
+            std::cout<<"Error: the binary mesh "<<filename<<" was not written"<<std::endl;
+        return written;
+    }
+
+    //Return the polygons of the mesh, after a local update it has erased polygons
+    const polygon_list &get_polygons() const {
+        return polygonal_mesh;
+    }
+
+    //Vertices of the polygon i as a view of the polygons of the mesh, valid until the mesh is updated
+    //After a local update the erased polygons are empty views, get_polygons().is_erased(i) is true
+    mesh_span<const int> get_polygon(int i) const {
+        if(polygonal_mesh.is_erased(i))
+            return mesh_span<const int>();
+        return polygonal_mesh.polygon(i);
+    }
+
+    //Vertices of all the polygons in one array, the polygon i is [offsets[i], offsets[i+1]) of get_polygon_vertices
+    //The number of polygons is get_polygon_offsets().size() - 1, including the erased polygons
+    mesh_span<const int> get_polygon_offsets() const {
+        return polygonal_mesh.get_offsets();
+    }
+
+    mesh_span<const int> get_polygon_vertices() const {
+        return polygonal_mesh.get_vertices();
+    }
+
+    //Neighbors of the polygon i, the polygons that share a frontier edge with it in the order of its boundary
+    //The adjacency is built the first time it is used after the polygons change, the view is valid until then
+    mesh_span<const int> get_polygon_neighbors(int i){
+        build_polygon_adjacency();
+        return mesh_span<const int>(adjacency.data() + adjacency_offsets.at(i), adjacency_offsets.at(i+1) - adjacency_offsets.at(i));
+    }
+
+    //Polygon adjacency in CSR format, the neighbors of the polygon i are [offsets[i], offsets[i+1]) of get_adjacency
+    //The polygons are numbered as in get_polygon, the erased polygons have no neighbors
+    mesh_span<const int> get_adjacency_offsets(){
+        build_polygon_adjacency();
+        return adjacency_offsets;
+    }
+
+    mesh_span<const int> get_adjacency(){
+        build_polygon_adjacency();
+        return adjacency;
+    }
+
+    //Return the number of polygons of the mesh, without the erased polygons
+    int get_n_polygons() const {
+        return m_polygons;
+    }
+
+    //Return the number of triangles of the triangulation
+    int get_n_triangles() const {
+        return tr->faces();
+    }
+
+    //Move vertices to new coordinates and update the polygons around them
+    //The halfedges are not changed, so the triangles incident to the moved vertices must keep their orientation.
+    //Only the terminal-edge regions that contain a triangle incident to a moved vertex, before or after the move,
+    //are traveled again. Their polygons are erased from polygonal_mesh and the new polygons are added at its end,
+    //the other polygons are not changed
+    //Input: vertices to move and their new coordinates x[i], y[i]
+    void move_vertices(const std::vector<int> &vertices, const std::vector<double> &x, const std::vector<double> &y){
+        instrumentation &stats = instrumentation::get();
+        stats.begin("move_vertices");
+        prepare_local_update();
+        for(std::size_t i = 0; i < vertices.size(); i++)
+            tr->set_Point(vertices[i], x.at(i), y.at(i));
+        //triangles incident to the moved vertices, their max edge can change
+        for(int v : vertices){
+            int e_init = tr->edge_of_vertex(v), e = e_init;
+            do{
+                if(tr->is_interior_face(e))
+                    add_to_region(tr->face_index(e), OLD_LABELS);
+                e = tr->CW_edge_to_vertex(e);
+            }while(e != e_init);
+        }
+        std::size_t n_moved_triangles = region.size();
+        //terminal-edge regions of the old labels, with the frontier edges added by their reparation
+        grow_label_region(0, OLD_LABELS);
+        int repaired_halfedges = count_repaired_halfedges(0, region.size());
+        for(std::size_t i = 0; i < n_moved_triangles; i++){
+            int e = tr->edge_of_face(region[i]);
+            for(int k = 0; k < 3; k++, e = tr->next(e))
+                max_edges[e] = false;
+            max_edges[label_max_edge(e)] = true;
+        }
+        //terminal-edge regions of the new labels, the regions of the old labels outside the moved triangles are not changed
+        std::size_t n_old = region.size();
+        grow_label_region(0, NEW_LABELS);
+        repaired_halfedges += count_repaired_halfedges(n_old, region.size());
+        int n_erased = retravel_region(repaired_halfedges/2);
+        stats.end();
+        stats.count("moved_vertices", vertices.size());
+        stats.count("moved_triangles", n_moved_triangles);
+        stats.count("region_triangles", region.size());
+        stats.count("erased_polygons", n_erased);
+        clear_region();
+    }
+
+    //Return the halfedge from v to w, -1 if they are not connected
+    int halfedge_between(int v, int w){
+        int e_init = tr->edge_of_vertex(v), e = e_init;
+        do{
+            if(tr->target(e) == w)
+                return e;
+            e = tr->CW_edge_to_vertex(e);
+        }while(e != e_init);
+        return -1;
+    }
+
+    //Label halfedges as constrained frontier edges, they split the polygons that contain them
+    //Only the polygons of the terminal-edge regions that contain the edges are traveled again, the new polygons
+    //are added at the end of polygonal_mesh. The constrained edges are kept by the next local updates
+    //Input: halfedges to constrain, the twin of each halfedge is also constrained
+    void add_constrained_edges(const std::vector<int> &edges){
+        instrumentation &stats = instrumentation::get();
+        stats.begin("add_constrained_edges");
+        prepare_local_update();
+        if(constrained_edges.empty())
+            constrained_edges.assign(tr->halfEdges(), false);
+        for(int e : edges){
+            if(constrained_edges.at(e))
+                continue;
+            for(int h : {e, tr->twin(e)})
+                if(tr->is_interior_face(h))
+                    add_to_region(tr->face_index(h), OLD_LABELS);
+        }
+        //the constrained edges only split the regions, so the region is not changed by them
+        grow_label_region(0, OLD_LABELS);
+        int repaired_halfedges = count_repaired_halfedges(0, region.size());
+        for(int e : edges){
+            constrained_edges[e] = true;
+            constrained_edges[tr->twin(e)] = true;
+        }
+        int n_erased = retravel_region(repaired_halfedges/2);
+        stats.end();
+        stats.count("constrained_edges", edges.size());
+        stats.count("region_triangles", region.size());
+        stats.count("erased_polygons", n_erased);
+        clear_region();
+    }
+
+    //Print a halfedge file
+    //The first line of the file is the number of halfedges
+    //The rest of the lines are the halfedges with the following format:
+    //origin target
+    void print_hedge(std::string file_name){
+        std::cout<<"Print halfedges"<<std::endl;
+        std::ofstream file;
+        file.open(file_name);
+        int n_frontier_edges = 0;
+        for(std::size_t i = 0; i < frontier_edges.size(); i++){
+            if(frontier_edges[i] == true){
+                n_frontier_edges++;
+            }
+        }
+        file<<n_frontier_edges<<std::endl;
+        for(std::size_t i = 0; i < tr->halfEdges(); i++){
+            if(frontier_edges[i] == true){
+                file<<tr->origin(i)<<" "<<tr->target(i)<<"\n";
+            }
+        }
+        file.close();
+    }
+
+    //Return a polygon generated from a seed edge
+    _polygon generate_polygon(int e)
+    {   
+        _polygon poly;
+        travel_triangles(e, poly);
+        return poly;
+    }
+
+
+protected:
+
+    //Number of seed edges traveled by each thread in a round of the streaming mode
+    static const std::size_t STREAM_BLOCK = 1 << 14;
+
+    //Add the polygon i of polygons to the OFF and ALE text of a chunk of the stream
+    void put_stream_polygon(polygon_stream::chunk &c, const polygon_list &polygons, std::size_t i){
+        c.off.put(polygons.size(i)).put(' ');
+        c.ale.put(polygons.size(i)).put(' ');
+        for(const int *v = polygons.begin(i); v != polygons.end(i); v++){
+            c.off.put(*v).put(' ');
+            c.ale.put(*v + 1).put(' ');
+        }
+        c.off.put('\n');
+        c.ale.put('\n');
+    }
+
+    //Give the headers and the vertices of the OFF and ALE files to the stream, the number of polygons is reserved
+    //The vertices are formatted in rounds of n_threads blocks as in write_parallel
+    void stream_vertices(){
+        polygon_stream::chunk *head = stream->acquire();
+        head->off.put("{ appearance  {+edge +face linewidth 2} LIST\n");
+        head->off.put("OFF\n");
+        head->off.put(tr->vertices()).put(' ');
+        stream->reserve_off_count(*head);
+        head->off.put(" 0\n");
+        head->ale.put("# domain type\nCustom\n");
+        head->ale.put("# nodal coordinates: number of nodes followed by the coordinates \n");
+        head->ale.put(tr->vertices()).put('\n');
+        stream->push(head);
+        std::vector<polygon_stream::chunk *> chunks(n_threads);
+        std::size_t n = tr->vertices();
+        for(std::size_t round = 0; round < n; round += STREAM_BLOCK*n_threads){
+            std::size_t round_end = std::min(n, round + STREAM_BLOCK*n_threads);
+            for(auto &c : chunks)
+                c = stream->acquire();
+            parallel_for_blocks(round, round_end, n_threads, [&](int id, std::size_t begin, std::size_t end){
+                polygon_stream::chunk &c = *chunks[id];
+                for(std::size_t v = begin; v < end; v++){
+                    c.off.put(tr->get_PointX(v), 15).put(' ').put(tr->get_PointY(v), 15).put(" 0\n");
+                    c.ale.put(tr->get_PointX(v), 15).put(' ').put(tr->get_PointY(v), 15).put('\n');
+                }
+            });
+            for(auto &c : chunks)
+                stream->push(c);
+        }
+        head = stream->acquire();
+        head->ale.put("# element connectivity: number of elements followed by the elements\n");
+        stream->reserve_ale_count(*head);
+        head->ale.put('\n');
+        stream->push(head);
+    }
+
+    //Travel phase of the streaming mode, the polygons are formatted and given to the stream instead of stored
+    //The seed edges are traveled in rounds of n_threads blocks, each thread formats the polygons of its block and the
+    //blocks are given to the stream in order, so the polygons are written in the order of travel_phase
+    //The memory of the polygons is bounded by the size of a round and the queue of the stream
+    void stream_travel_phase(){
+        m_polygons = 0;
+        buffers.resize(n_threads);
+        for(auto &buffer : buffers)
+            buffer.n_barrier_edge_tips = 0;
+        std::vector<polygon_stream::chunk *> chunks(n_threads);
+        std::size_t n = seed_edges.size();
+        for(std::size_t round = 0; round < n; round += STREAM_BLOCK*n_threads){
+            std::size_t round_end = std::min(n, round + STREAM_BLOCK*n_threads);
+            for(auto &c : chunks)
+                c = stream->acquire();
+            parallel_for_blocks(round, round_end, n_threads, [&](int id, std::size_t begin, std::size_t end){
+                travel_buffers &buffer = buffers[id];
+                buffer.polygons.clear();
+                for(std::size_t i = begin; i < end; i++)
+                    travel_seed(seed_edges[i], buffer);
+                for(std::size_t i = 0; i < buffer.polygons.size(); i++)
+                    put_stream_polygon(*chunks[id], buffer.polygons, i);
+            });
+            for(int i = 0; i < n_threads; i++){
+                m_polygons += buffers[i].polygons.size();
+                stream->push(chunks[i]);
             }
-            out<<std::endl; 
         }
+        for(int i = 0; i < n_threads; i++){
+            n_barrier_edge_tips += buffers[i].n_barrier_edge_tips;
+            n_frontier_edges += 2*buffers[i].n_barrier_edge_tips;
+            buffers[i].polygons.clear();
+        }
+    }
+
+    //Give the ends of the files to the stream and write the number of polygons when they are written
+    void stream_end(){
+        instrumentation::get().begin("write_stream");
+        polygon_stream::chunk *tail = stream->acquire();
+        tail->off.put("}\n");
+        put_ALE_tail(tail->ale);
+        stream->push(tail);
+        stream->close(m_polygons);
+        instrumentation::get().end();
+        instrumentation::get().count("polygons", m_polygons);
+    }
+
+    //Add the end of the ale file to b, the boundary and the bounding box of the triangulation
+    void put_ALE_tail(text_buffer &b){
         //Print borderedges
-        out<<"# indices of nodes located on the Dirichlet boundary\n";
+        b.put("# indices of nodes located on the Dirichlet boundary\n");
         ///Find borderedges
         int b_curr, b_init = 0;
         for(std::size_t i = tr->halfEdges()-1; i != 0; i--){
@@ -175,15 +682,15 @@ public:
                 break;
             }
         }
-        out<<tr->origin(b_init) + 1<<" ";
+        b.put(tr->origin(b_init) + 1).put(' ');
         b_curr = tr->prev(b_init);
         while(b_init != b_curr){
-            out<<tr->origin(b_curr) + 1<<" ";
+            b.put(tr->origin(b_curr) + 1).put(' ');
             b_curr = tr->prev(b_curr);
         }
-        out<<std::endl;
-        out<<"# indices of nodes located on the Neumann boundary\n0\n";
-        out<<"# xmin, xmax, ymin, ymax of the bounding box\n";
+        b.put('\n');
+        b.put("# indices of nodes located on the Neumann boundary\n0\n");
+        b.put("# xmin, xmax, ymin, ymax of the bounding box\n");
         double xmax = tr->get_PointX(0);
         double xmin = tr->get_PointX(0);
         double ymax = tr->get_PointY(0);
@@ -201,79 +708,437 @@ public:
             if(tr->get_PointY(v) < ymin )
                 ymin = tr->get_PointY(v);
         }
-        out<<xmin<<" "<<xmax<<" "<<ymin<<" "<<ymax<<std::endl;
-        out.close();
+        b.put(xmin, 15).put(' ').put(xmax, 15).put(' ').put(ymin, 15).put(' ').put(ymax, 15).put('\n');
     }
 
-    //Print off file of the polylla mesh
-    void print_OFF(std::string filename){
-        std::ofstream out(filename);
-        _polygon poly;
-        out<<"{ appearance  {+edge +face linewidth 2} LIST\n";
-        out<<"OFF"<<std::endl;
-        //num_vertices num_polygons 0
-        out<<std::setprecision(15)<<tr->vertices()<<" "<<m_polygons<<" 0"<<std::endl;
-        //print nodes
-        for(std::size_t v = 0; v < tr->vertices(); v++)
-            out<<tr->get_PointX(v)<<" "<<tr->get_PointY(v)<<" 0"<<std::endl; 
-        //print polygons
-        for(auto &i : polygonal_mesh){
-            out<<i.vertices.size()<<" ";
-            for(auto &v : i.vertices){
-                out<<v<<" ";
+    //Build the polygon adjacency if the polygons changed since it was built
+    //1. Each thread travels the frontier edges of a block of polygons from their seeds and records the polygon of
+    //   each frontier halfedge, each polygon writes only its own halfedges.
+    //2. The neighbor across a frontier halfedge is the polygon of its twin. Each thread collects the neighbors of its
+    //   block of polygons without repeats, then the blocks are copied in order to the CSR arrays
+    //The halfedges are not stored by the travel phase, that would slow down the travel of every mesh
+    void build_polygon_adjacency(){
+        if(!adjacency_offsets.empty())
+            return;
+        instrumentation &stats = instrumentation::get();
+        stats.begin("polygon_adjacency");
+        auto t_start = std::chrono::high_resolution_clock::now();
+        std::size_t n_polygons = polygonal_mesh.size();
+        std::vector<int> edge_polygon(tr->halfEdges(), -1);
+        //frontier halfedges of the polygons of each thread, the halfedges of the polygon i end in polygon_end[i]
+        std::vector<std::vector<int>> local_edges(n_threads);
+        std::vector<std::size_t> polygon_end(n_polygons);
+        parallel_for_blocks(0, n_polygons, n_threads, [&](int id, std::size_t begin, std::size_t end){
+            std::vector<int> &edges = local_edges[id];
+            for(std::size_t i = begin; i < end; i++){
+                if(!polygonal_mesh.is_erased(i)){
+                    std::size_t first = edges.size();
+                    travel_frontier_edges(polygonal_mesh.seed(i), edges);
+                    for(std::size_t k = first; k < edges.size(); k++)
+                        edge_polygon[edges[k]] = i;
+                }
+                polygon_end[i] = edges.size();
             }
-            out<<std::endl; 
+        });
+        adjacency_offsets.assign(n_polygons + 1, 0);
+        std::vector<std::vector<int>> local_neighbors(n_threads);
+        parallel_for_blocks(0, n_polygons, n_threads, [&](int id, std::size_t begin, std::size_t end){
+            const std::vector<int> &edges = local_edges[id];
+            std::vector<int> &neighbors = local_neighbors[id];
+            std::size_t k = 0;
+            for(std::size_t i = begin; i < end; i++){
+                std::size_t first = neighbors.size();
+                for(; k < polygon_end[i]; k++){
+                    int q = edge_polygon[tr->twin(edges[k])];
+                    //border edges, barrier edges and edges shared again with a neighbor
+                    if(q == -1 || q == (int)i || std::find(neighbors.begin() + first, neighbors.end(), q) != neighbors.end())
+                        continue;
+                    neighbors.push_back(q);
+                }
+                adjacency_offsets[i+1] = neighbors.size() - first;
+            }
+        });
+        for(std::size_t i = 0; i < n_polygons; i++)
+            adjacency_offsets[i+1] += adjacency_offsets[i];
+        adjacency.resize(adjacency_offsets[n_polygons]);
+        std::vector<std::size_t> offset(n_threads + 1, 0);
+        for(int i = 0; i < n_threads; i++)
+            offset[i+1] = offset[i] + local_neighbors[i].size();
+        parallel_for_blocks(0, n_threads, n_threads, [&](int, std::size_t begin, std::size_t end){
+            for(std::size_t i = begin; i < end; i++)
+                std::copy(local_neighbors[i].begin(), local_neighbors[i].end(), adjacency.begin() + offset[i]);
+        });
+        auto t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        stats.count("adjacencies", adjacency.size());
+        double elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
+        std::cout<<"Polygon adjacency built in "<<elapsed_time_ms<<" ms with "<<n_threads<<" threads"<<std::endl;
+    }
+
+    //Add the size of the triangulation to the last phase recorded
+    void count_triangulation(){
+        instrumentation &stats = instrumentation::get();
+        stats.count("vertices", tr->vertices());
+        stats.count("triangles", tr->faces());
+        stats.count("halfedges", tr->halfEdges());
+    }
+
+    //Set the triangulation to the Delaunay triangulation of the points, the repeated points are removed
+    //Throw std::runtime_error if the points can not be triangulated
+    void triangulate_points(std::vector<double> &points){
+        instrumentation &stats = instrumentation::get();
+        stats.begin("delaunay");
+        auto t_start = std::chrono::high_resolution_clock::now();
+        std::vector<int> faces, neighs;
+        std::vector<char> border;
+        if(!delaunay::triangulate(points, faces, neighs, border, n_threads))
+            throw std::runtime_error("unable to compute the Delaunay triangulation of " + std::to_string(points.size()/2) + " points");
+        auto t_end = std::chrono::high_resolution_clock::now();
+        stats.count("points", points.size()/2);
+        stats.end();
+        double elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
+        std::cout<<"Delaunay triangulation of "<<points.size()/2<<" points in "<<elapsed_time_ms<<" ms"<<std::endl;
+        stats.begin("triangulation");
+        t_start = std::chrono::high_resolution_clock::now();
+        this->tr = new Mesh(points, border, faces, neighs);
+        t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        count_triangulation();
+        elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
+        std::cout<<"Triangulation generated "<<elapsed_time_ms<<" ms"<<std::endl;
+    }
+
+    //Load a binary mesh file, the triangulation uses the arrays of the file in place
+    //If the file has the labels and polygons of a mesh they are loaded, else the mesh is generated
+    //Throw std::runtime_error if the labels or the polygons of the file do not match the triangulation
+    void load_binary(std::string filename){
+        instrumentation &stats = instrumentation::get();
+        stats.begin("load_triangulation");
+        auto t_start = std::chrono::high_resolution_clock::now();
+        auto file = std::make_shared<mesh_binary::file>(filename);
+        this->tr = new Mesh(file);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        count_triangulation();
+        double elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
+        std::cout<<"Triangulation loaded "<<elapsed_time_ms<<" ms"<<std::endl;
+        if(!file->has(mesh_binary::POLYGON_OFFSETS)){
+            construct_Polylla();
+            return;
+        }
+        stats.begin("load_polygons");
+        t_start = std::chrono::high_resolution_clock::now();
+        std::size_t n, n_vertices, n_seeds;
+        char *max = file->get<char>(mesh_binary::MAX_EDGES, n);
+        max_edges.assign(max, max + n);
+        char *frontier = file->get<char>(mesh_binary::FRONTIER_EDGES, n);
+        frontier_edges.assign(frontier, frontier + n);
+        int *seeds = file->get<int>(mesh_binary::SEED_EDGES, n);
+        seed_edges.assign(seeds, seeds + n);
+        int *offsets = file->get<int>(mesh_binary::POLYGON_OFFSETS, n);
+        int *vertices = file->get<int>(mesh_binary::POLYGON_VERTICES, n_vertices);
+        int *polygon_seeds = file->get<int>(mesh_binary::POLYGON_SEEDS, n_seeds);
+        if(max_edges.size() != (std::size_t)tr->halfEdges() || frontier_edges.size() != (std::size_t)tr->halfEdges())
+            throw std::runtime_error("the labels of the binary file " + filename + " do not match its triangulation");
+        for(int e : seed_edges)
+            if(e < 0 || e >= tr->halfEdges())
+                throw std::runtime_error("the binary file " + filename + " has a seed edge out of range");
+        //the polygon i is vertices[offsets[i] .. offsets[i+1]], the offsets must be increasing and inside the vertices
+        if(n != n_seeds + 1 || offsets[0] != 0 || (std::size_t)offsets[n_seeds] > n_vertices)
+            throw std::runtime_error("the polygons of the binary file " + filename + " have wrong offsets");
+        for(std::size_t i = 0; i < n_seeds; i++)
+            if(offsets[i+1] < offsets[i] || polygon_seeds[i] < -1 || polygon_seeds[i] >= tr->halfEdges())
+                throw std::runtime_error("the polygon " + std::to_string(i) + " of the binary file " + filename + " is not valid");
+        for(std::size_t i = 0; i < n_vertices; i++)
+            if(vertices[i] < 0 || vertices[i] >= tr->vertices())
+                throw std::runtime_error("the polygons of the binary file " + filename + " have a vertex out of range");
+        polygonal_mesh.assign(offsets, n_seeds, vertices, polygon_seeds);
+        adjacency_offsets.clear();
+        const mesh_binary::header &h = file->get_header();
+        this->m_polygons = h.n_polygons;
+        this->n_frontier_edges = h.n_frontier_edges;
+        this->n_barrier_edge_tips = h.n_barrier_edge_tips;
+        t_end = std::chrono::high_resolution_clock::now();
+        stats.end();
+        stats.count("polygons", m_polygons);
+        elapsed_time_ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
+        std::cout<<"Polygons loaded in "<<elapsed_time_ms<<" ms"<<std::endl;
+        std::cout<<"Mesh with "<<m_polygons<<" polygons "<<n_frontier_edges/2<<" edges and "<<n_barrier_edge_tips<<" barrier-edge tips."<<std::endl;
+        //the polygons of the file are written to the stream as they are
+        if(stream){
+            stream_vertices();
+            polygon_stream::chunk *c = stream->acquire();
+            for(std::size_t i = 0; i < polygonal_mesh.size(); i++)
+                if(!polygonal_mesh.is_erased(i))
+                    put_stream_polygon(*c, polygonal_mesh, i);
+            stream->push(c);
+            stream_end();
         }
-        out<<"}"<<std::endl;
-        out.close();
     }
 
-    //Print a halfedge file
-    //The first line of the file is the number of halfedges
-    //The rest of the lines are the halfedges with the following format:
-    //origin target
-    void print_hedge(std::string file_name){
-        std::cout<<"Print halfedges"<<std::endl;
-        std::ofstream file;
-        file.open(file_name);
-        int n_frontier_edges = 0;
-        for(std::size_t i = 0; i < frontier_edges.size(); i++){
-            if(frontier_edges[i] == true){
-                n_frontier_edges++;
+    //Labels that added a face to the region of a local update
+    static constexpr char OLD_LABELS = 1;
+    static constexpr char NEW_LABELS = 2;
+
+    //Build the state of the local updates, the polygon of each face is found from its seed edge
+    void prepare_local_update(){
+        if(in_region.size() != tr->faces())
+            in_region.assign(tr->faces(), false);
+        if(face_polygon.size() == tr->faces())
+            return;
+        face_polygon.assign(tr->faces(), -1);
+        for(std::size_t i = 0; i < polygonal_mesh.size(); i++)
+            if(!polygonal_mesh.is_erased(i))
+                set_face_polygon(tr->face_index(polygonal_mesh.seed(i)), i);
+    }
+
+    void add_to_region(int f, char labels){
+        if(!in_region[f]){
+            in_region[f] = labels;
+            region.push_back(f);
+        }
+    }
+
+    void clear_region(){
+        for(int f : region)
+            in_region[f] = false;
+        region.clear();
+    }
+
+    //Add to the region the faces connected to the faces region[first..] by edges that are not frontier
+    //edges of the labels or constrained edges, so the region has all the faces of the polygons of its faces
+    void grow_label_region(std::size_t first, char labels){
+        for(std::size_t i = first; i < region.size(); i++){
+            int e = tr->edge_of_face(region[i]);
+            for(int k = 0; k < 3; k++, e = tr->next(e)){
+                int twin = tr->twin(e);
+                if(tr->is_interior_face(twin) && !is_frontier_edge(e))
+                    add_to_region(tr->face_index(twin), labels);
             }
         }
-        file<<n_frontier_edges<<std::endl;
-        for(std::size_t i = 0; i < tr->halfEdges(); i++){
-            if(frontier_edges[i] == true){
-                file<<tr->origin(i)<<" "<<tr->target(i)<<"\n";
+    }
+
+    //Number of halfedges of the faces region[begin..end) that are frontier edges only because of a reparation
+    //The halfedges whose twin was added to the region with the old labels are skipped, they are frontier edges
+    //of the old labels that can be changed by the new labels
+    int count_repaired_halfedges(std::size_t begin, std::size_t end){
+        int n = 0;
+        for(std::size_t i = begin; i < end; i++){
+            int e = tr->edge_of_face(region[i]);
+            for(int k = 0; k < 3; k++, e = tr->next(e)){
+                int twin = tr->twin(e);
+                bool old_twin = tr->is_interior_face(twin) && in_region[tr->face_index(twin)] == OLD_LABELS;
+                if(in_region[region[i]] == NEW_LABELS && old_twin)
+                    continue;
+                if(frontier_edges[e] && !is_frontier_edge(e))
+                    n++;
             }
         }
-        file.close();
+        return n;
     }
 
-    //Return a polygon generated from a seed edge
-    _polygon generate_polygon(int e)
-    {   
-        _polygon poly;
-        //search next frontier-edge
-        int e_init = search_frontier_edge(e);
-        int v_init = tr->origin(e_init);
-        int e_curr = tr->next(e_init);
-        int v_curr = tr->origin(e_curr);
-        poly.push_back(v_curr);
-        while(e_curr != e_init && v_curr != v_init)
-        {   
-            e_curr = search_frontier_edge(e_curr);  
-            //select triangle that contains v_curr as origin
-            e_curr = tr->next(e_curr);
-            v_curr = tr->origin(e_curr);
-            poly.push_back(v_curr);
+    //Assign the polygon p to the faces connected to the face f by edges that are not frontier edges
+    void set_face_polygon(int f, int p){
+        std::vector<int> &stack = face_stack;
+        stack.clear();
+        face_polygon[f] = p;
+        stack.push_back(f);
+        while(!stack.empty()){
+            int e = tr->edge_of_face(stack.back());
+            stack.pop_back();
+            for(int k = 0; k < 3; k++, e = tr->next(e)){
+                int twin = tr->twin(e);
+                if(frontier_edges[e] || tr->is_border_face(twin) || face_polygon[tr->face_index(twin)] == p)
+                    continue;
+                face_polygon[tr->face_index(twin)] = p;
+                stack.push_back(tr->face_index(twin));
+            }
         }
-        return poly;
     }
 
+    //Number of frontier halfedges of the faces of the region and their twins, the twins inside the region are counted once
+    int count_region_frontier_edges(){
+        int n = 0;
+        for(int f : region){
+            int e = tr->edge_of_face(f);
+            for(int k = 0; k < 3; k++, e = tr->next(e)){
+                int twin = tr->twin(e);
+                n += frontier_edges[e];
+                if(tr->is_border_face(twin) || !in_region[tr->face_index(twin)])
+                    n += frontier_edges[twin];
+            }
+        }
+        return n;
+    }
+
+    //Replace the polygons of the region, it must be a union of parts of terminal-edge regions split by the
+    //frontier edges of the current labels and the constrained edges
+    //Input: number of barrier-edge tips repaired in the old polygons of the region
+    //Output: number of polygons erased
+    int retravel_region(int old_barrier_edge_tips){
+        //erase the old polygons and label the frontier edges again
+        adjacency_offsets.clear();
+        int n_erased = 0;
+        int old_frontier = count_region_frontier_edges();
+        for(int f : region){
+            int p = face_polygon[f];
+            if(p != -1 && !polygonal_mesh.is_erased(p)){
+                polygonal_mesh.erase(p);
+                n_erased++;
+            }
+            face_polygon[f] = -1;
+            int e = tr->edge_of_face(f);
+            for(int k = 0; k < 3; k++, e = tr->next(e)){
+                frontier_edges[e] = is_frontier_edge(e);
+                frontier_edges[tr->twin(e)] = is_frontier_edge(tr->twin(e));
+            }
+        }
+        //seed edges of the region, in the order of the halfedges as in label_seed_edges
+        //the constrained edges are also seeds, the parts of a terminal-edge region split by them have no terminal edge
+        region_seeds.clear();
+        for(int f : region){
+            int e = tr->edge_of_face(f);
+            for(int k = 0; k < 3; k++, e = tr->next(e))
+                if(is_seed_edge(e) || (!constrained_edges.empty() && constrained_edges[e]))
+                    region_seeds.push_back(e);
+        }
+        std::sort(region_seeds.begin(), region_seeds.end());
+        if(buffers.empty())
+            buffers.resize(1);
+        travel_buffers &buffer = buffers[0];
+        buffer.polygons.clear();
+        buffer.n_barrier_edge_tips = 0;
+        std::size_t first = polygonal_mesh.size();
+        for(int e : region_seeds){
+            if(face_polygon[tr->face_index(e)] != -1) //the polygon of the seed was generated by another seed
+                continue;
+            std::size_t n = buffer.polygons.size();
+            travel_triangles(e, buffer.poly);
+            if(!has_BarrierEdgeTip(buffer.poly))
+                buffer.polygons.push_back(e, buffer.poly.begin(), buffer.poly.end());
+            else
+                buffer.n_barrier_edge_tips += barrieredge_tip_reparation(e, buffer.poly, buffer);
+            for(std::size_t i = n; i < buffer.polygons.size(); i++)
+                set_face_polygon(tr->face_index(buffer.polygons.seed(i)), first + i);
+        }
+        polygonal_mesh.append(buffer.polygons);
+        //the frontier edges are counted again, a middle edge of a reparation can already be a constrained edge
+        n_frontier_edges += count_region_frontier_edges() - old_frontier;
+        n_barrier_edge_tips += buffer.n_barrier_edge_tips - old_barrier_edge_tips;
+        m_polygons = polygonal_mesh.size() - polygonal_mesh.n_erased();
+        seed_edges_outdated = true;
+        return n_erased;
+    }
+
+    //Triangles whose longest edges are found together in label_max_edges
+    static constexpr int MAX_EDGE_CHUNK = 256;
+
+    //Label the max edge of each triangle
+    //Each triangle only writes its own max edge, so the blocks of triangles write disjoint positions of max_edges
+    //The corners of MAX_EDGE_CHUNK triangles are copied to arrays and their longest edges are found together by the
+    //vectorized kernel of max_edge_kernel.hpp, with the same result of label_max_edge
+    void label_max_edges(){
+        max_edge_kernel::point_arrays points = tr->get_point_arrays();
+        parallel_for_blocks(0, tr->faces(), n_threads, [&](int, std::size_t begin, std::size_t end){
+            int edges[3][MAX_EDGE_CHUNK], corners[3][MAX_EDGE_CHUNK];
+            unsigned char max[MAX_EDGE_CHUNK];
+            for(std::size_t t = begin; t < end; t += MAX_EDGE_CHUNK){
+                std::size_t n = std::min<std::size_t>(MAX_EDGE_CHUNK, end - t);
+                for(std::size_t i = 0; i < n; i++){
+                    int e = tr->edge_of_face(t + i);
+                    for(int k = 0; k < 3; k++, e = tr->next(e)){
+                        edges[k][i] = e;
+                        corners[k][i] = tr->origin(e);
+                    }
+                }
+                max_edge_kernel::longest_edges(points, corners[0], corners[1], corners[2], n, max);
+                for(std::size_t i = 0; i < n; i++)
+                    max_edges[edges[max[i]][i]] = true;
+            }
+        });
+    }
+
+    //Label frontier edges, each halfedge is only written by the thread that owns its block
+    void label_frontier_edges(){
+        std::vector<int> count(n_threads, 0);
+        parallel_for_blocks(0, tr->halfEdges(), n_threads, [&](int id, std::size_t begin, std::size_t end){
+            for (std::size_t e = begin; e < end; e++){
+                if(is_frontier_edge(e)){
+                    frontier_edges[e] = true;
+                    count[id]++;
+                }
+            }
+        });
+        for(auto &c : count)
+            n_frontier_edges += c;
+    }
+
+    //Label seed edges
+    //Each thread collects the seeds of its block, then the blocks are copied to seed_edges in order,
+    //so seed_edges has the same order of the serial loop
+    void label_seed_edges(){
+        std::vector<std::vector<int>> local_seeds(n_threads);
+        parallel_for_blocks(0, tr->halfEdges(), n_threads, [&](int id, std::size_t begin, std::size_t end){
+            for (std::size_t e = begin; e < end; e++)
+                if(tr->is_interior_face(e) && is_seed_edge(e))
+                    local_seeds[id].push_back(e);
+        });
+        std::vector<std::size_t> offset(n_threads + 1, 0);
+        for(int i = 0; i < n_threads; i++)
+            offset[i+1] = offset[i] + local_seeds[i].size();
+        seed_edges.resize(offset[n_threads]);
+        parallel_for_blocks(0, n_threads, n_threads, [&](int, std::size_t begin, std::size_t end){
+            for(std::size_t i = begin; i < end; i++)
+                std::copy(local_seeds[i].begin(), local_seeds[i].end(), seed_edges.begin() + offset[i]);
+        });
+    }
 
-private:
+    //Generate a polygon from each seed edge, polygons with barrier-edge tips are repaired
+    //Each thread travels a block of seed_edges and stores its polygons, simple and repaired, in its own list.
+    //Terminal-edge regions are disjoint, so the frontier-edges added by a reparation are only read by the thread
+    //that travels that region. The lists are appended in block order, so polygonal_mesh has the same order
+    //of the serial loop for any number of threads.
+    //The list of the first thread is swapped with polygonal_mesh when it is empty, so with one thread the
+    //polygons are not copied, and the buffers are kept for the next travel
+    void travel_phase(){
+        adjacency_offsets.clear();
+        buffers.resize(n_threads);
+        for(auto &buffer : buffers){
+            buffer.polygons.clear();
+            buffer.n_barrier_edge_tips = 0;
+        }
+        parallel_for_blocks(0, seed_edges.size(), n_threads, [&](int id, std::size_t begin, std::size_t end){
+            for(std::size_t i = begin; i < end; i++)
+                travel_seed(seed_edges[i], buffers[id]);
+        });
+        int first = 0;
+        if(polygonal_mesh.size() == 0){
+            polygonal_mesh.swap(buffers[0].polygons);
+            first = 1;
+        }
+        std::size_t n_polygons = polygonal_mesh.size(), n_polygon_vertices = polygonal_mesh.n_vertices();
+        for(int i = first; i < n_threads; i++){
+            n_polygons += buffers[i].polygons.size();
+            n_polygon_vertices += buffers[i].polygons.n_vertices();
+        }
+        polygonal_mesh.reserve(n_polygons, n_polygon_vertices);
+        for(int i = 0; i < n_threads; i++){
+            if(i >= first)
+                polygonal_mesh.append(buffers[i].polygons);
+            n_barrier_edge_tips += buffers[i].n_barrier_edge_tips;
+            n_frontier_edges += 2*buffers[i].n_barrier_edge_tips;
+        }
+    }
+
+    //Generate the polygons of a seed edge in the list of the buffer
+    void travel_seed(int e, travel_buffers &buffer){
+        travel_triangles(e, buffer.poly);
+        if(!has_BarrierEdgeTip(buffer.poly)){ //If the polygon is a simple polygon then is part of the mesh
+            buffer.polygons.push_back(e, buffer.poly.begin(), buffer.poly.end());
+        }else{ //Else, the polygon is send to reparation phase
+            buffer.n_barrier_edge_tips += barrieredge_tip_reparation(e, buffer.poly, buffer);
+        }
+    }
 
     //Return true is the edge is terminal-edge or terminal border edge, 
     //but it only selects one halfedge as terminal-edge, the halfedge with lowest index is selected
@@ -298,24 +1163,10 @@ private:
     //output: position of edge e in max_edges[e] is labeled as true
     int label_max_edge(const int e)
     {
-        //Calculates the size of each edge of a triangle 
-
-        double dist0 = tr->distance(e);
-        double dist1 = tr->distance(tr->next(e));
-        double dist2 = tr->distance(tr->next(tr->next(e)));
-
-        short max;
-        //Find the longest edge of the triangle
-        if((dist0 >= dist1 && dist1 >= dist2) || (dist0 >= dist2 && dist2 >= dist1)){
-            max = 0; //edge face[0]-face[1] is max
-        }else if( (dist1 >= dist0 && dist0 >= dist2) || (dist1 >= dist2 && dist2 >= dist0)){
-            max = 1; //edge face[1]-face[2] is max
-        }else if( (dist2 >= dist1 && dist1 >= dist0) || (dist2 >= dist0 && dist0 >= dist1)){
-            max = 2; //edge face[2]-face[0] is max
-        }else{
-            std::cout<<"ERROR: max edge not found"<<std::endl;
-            exit(0);
-        }
+        //Compare the squared lengths of the edges, exactly if they are close (predicates.hpp)
+        int v0 = tr->origin(e), v1 = tr->origin(tr->next(e)), v2 = tr->origin(tr->next(tr->next(e)));
+        short max = predicates::longest_edge(tr->get_PointX(v0), tr->get_PointY(v0), tr->get_PointX(v1), tr->get_PointY(v1),
+            tr->get_PointX(v2), tr->get_PointY(v2));
         int init_vertex = tr->origin(e);
         int curr_vertex = -1;
         int nxt = e;
@@ -336,13 +1187,14 @@ private:
 
  
     //Return true if the edge e is the lowest edge both triangles incident to e
-    //in case of border edges, they are always labeled as frontier-edge
+    //in case of border edges and constrained edges, they are always labeled as frontier-edge
     bool is_frontier_edge(const int e)
     {
         int twin = tr->twin(e);
         bool is_border_edge = tr->is_border_face(e) || tr->is_border_face(twin);
         bool is_not_max_edge = !(max_edges[e] || max_edges[twin]);
-        if(is_border_edge || is_not_max_edge)
+        bool is_constrained = !constrained_edges.empty() && constrained_edges[e];
+        if(is_border_edge || is_not_max_edge || is_constrained)
             return true;
         else
             return false;
@@ -360,7 +1212,7 @@ private:
     }
 
     //return true if the polygon is not simple
-    bool has_BarrierEdgeTip(std::vector<int> poly){
+    bool has_BarrierEdgeTip(const _polygon &poly){
         int length_poly = poly.size();
         int x, y, i;
         for (i = 0; i < length_poly; i++)
@@ -374,9 +1226,10 @@ private:
     }   
 
     //generate a polygon from a seed edge
-    _polygon travel_triangles(const int e)
+    //input: seed edge e, poly is replaced by the vertices of the polygon
+    void travel_triangles(const int e, _polygon &poly)
     {   
-        _polygon poly;
+        poly.clear();
         //search next frontier-edge
         int e_init = search_frontier_edge(e);
         int v_init = tr->origin(e_init);
@@ -393,9 +1246,26 @@ private:
             //v_curr is part of the polygon
             poly.push_back(v_curr);
         }
-        return poly;
     }
     
+    //Frontier halfedges of the polygon generated by a seed edge, the same travel of travel_triangles
+    //input: seed edge e, the halfedges are added at the end of edges
+    void travel_frontier_edges(const int e, std::vector<int> &edges)
+    {
+        int e_init = search_frontier_edge(e);
+        int v_init = tr->origin(e_init);
+        int e_curr = tr->next(e_init);
+        int v_curr = tr->origin(e_curr);
+        edges.push_back(e_init);
+        while(e_curr != e_init && v_curr != v_init)
+        {
+            e_curr = search_frontier_edge(e_curr);
+            edges.push_back(e_curr);
+            e_curr = tr->next(e_curr);
+            v_curr = tr->origin(e_curr);
+        }
+    }
+
     //Given a barrier-edge tip v, return the middle edge incident to v
     //The function first calculate the degree of v - 1 and then divide it by 2, after travel to until the middle-edge
     //input: vertex v
@@ -432,25 +1302,28 @@ private:
     }
 
     //Given a seed edge e and a polygon poly generated by e, split the polygon until remove al barrier-edge tips
-    //input: seed edge e, polygon poly
-    //output: polygon without barrier-edge tips
-    void barrieredge_tip_reparation(const int e, std::vector<int> &poly)
+    //input: seed edge e, polygon poly, buffers of the thread
+    //output: number of barrier-edge tips repaired, the polygons without barrier-edge tips are added to buffer.polygons
+    int barrieredge_tip_reparation(const int e, const _polygon &poly, travel_buffers &buffer)
     {
         int x, y, i;
         int t1, t2;
         int middle_edge, v_bet;
+        int n_bet = 0;
 
         //list is initialize
-        std::vector<int> triangle_list;
-        bit_vector seed_bet_mark(this->tr->halfEdges(), false);
+        std::vector<int> &triangle_list = buffer.repair_seeds;
+        triangle_list.clear();
+        //a polygon has at most one barrier-edge tip per vertex, and each one adds two seeds
+        edge_set &seed_bet_mark = buffer.repair_marks;
+        seed_bet_mark.reset(2*poly.size());
         //look for barrier-edge tips
         for (i = 0; i < poly.size(); i++)
         {
             x = i;
             y = (i+2) % poly.size();
             if (poly[x] == poly[y]){
-                n_barrier_edge_tips++;
-                n_frontier_edges+=2;
+                n_bet++;
                 //select edge with bet
                 v_bet= poly[(i+1) % poly.size()];
                 //middle edge that contains v_bet
@@ -464,67 +1337,70 @@ private:
                 triangle_list.push_back(t1);
                 triangle_list.push_back(t2);
 
-                seed_bet_mark[t1] = true;
-                seed_bet_mark[t2] = true;
+                seed_bet_mark.insert(t1);
+                seed_bet_mark.insert(t2);
             }
         }
         int t_curr;
-        _polygon poly_curr;
+        _polygon &poly_curr = buffer.repaired;
         //generate polygons from seeds,
         //two seeds can generate the same polygon
-        //so the bit_vector seed_bet_mark is used to label as false the edges that are already used
+        //so the set seed_bet_mark is used to remove the edges that are already used
         while (!triangle_list.empty())
         {
             t_curr = triangle_list.back();
             triangle_list.pop_back();
-            if(seed_bet_mark[t_curr]){
-                seed_bet_mark[t_curr] = false;
-                poly_curr = generate_repaired_polygon(t_curr, seed_bet_mark);
+            if(seed_bet_mark.contains(t_curr)){
+                seed_bet_mark.erase(t_curr);
+                generate_repaired_polygon(t_curr, seed_bet_mark, poly_curr);
                 //Store the polygon in the as part of the mesh
-                this->polygonal_mesh.push_back({t_curr, poly_curr});
+                buffer.polygons.push_back(t_curr, poly_curr.begin(), poly_curr.end());
             }
         }
+        return n_bet;
     }
 
 
     //Generate a polygon from a seed-edge and remove repeated seed from seed_list
     //POSIBLE BUG: el algoritmo no viaja por todos los halfedges dentro de un poligono, 
     //por lo que pueden haber semillas que no se borren y tener poligonos repetidos de output
-    _polygon generate_repaired_polygon(const int e, bit_vector &seed_list)
+    //poly is replaced by the vertices of the polygon
+    void generate_repaired_polygon(const int e, edge_set &seed_list, _polygon &poly)
     {   
-        _polygon poly;
+        poly.clear();
         int e_init = e;
         //search next frontier-edge
         while(!frontier_edges[e_init])
         {
             e_init = tr->CW_edge_to_vertex(e_init);
-            seed_list[e_init] = false; 
+            seed_list.erase(e_init); 
             //seed_list[tr->twin(e_init)] = false;
         }        
         int v_init = tr->origin(e_init);
         int e_curr = tr->next(e_init);
         int v_curr = tr->origin(e_curr);
         poly.push_back(v_curr);
-        seed_list[e_curr] = false;
+        seed_list.erase(e_curr);
         //seed_list[tr->twin(e_curr)] = false;
         while(e_curr != e_init && v_curr != v_init)
         {   
             while(!frontier_edges[e_curr])
             {
                 e_curr = tr->CW_edge_to_vertex(e_curr);
-                seed_list[e_curr] = false;
+                seed_list.erase(e_curr);
           //      seed_list[tr->twin(e_curr)] = false;
             } 
-            seed_list[e_curr] = false;
+            seed_list.erase(e_curr);
             //seed_list[tr->twin(e_curr)] = false;
             e_curr = tr->next(e_curr);
             v_curr = tr->origin(e_curr);
             poly.push_back(v_curr);
-            seed_list[e_curr] = false;
+            seed_list.erase(e_curr);
             //seed_list[tr->twin(e_curr)] = false;
         }
-        return poly;
     }
 };
 
+typedef PolyllaMesh<Triangulation> Polylla;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,295 @@
+/* Robust comparison of the lengths of two edges
+    compare_lengths(a, b, c, d) returns the sign of |ab|^2 - |cd|^2, the points are given by their coordinates.
+    The squared lengths are compared without sqrt, first with doubles and an error bound (filter): if the
+    difference is larger than the bound its sign is correct. Only near-ties are computed again exactly with
+    floating-point expansions (Shewchuk, Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric
+    Predicates, 1997), so the result is always the sign of the exact difference of the squared lengths of the
+    points stored as doubles.
+
+    Bound of the filter: each coordinate difference, square and sum has a relative error of at most u = 2^-53 and
+    the terms are positive, so a squared length L is computed with an error of at most (3u + 3u^2 + u^3) L and the
+    error of the difference is at most (4u + 7u^2)(L1 + L2). The bound (6u + 16u^2)(L1 + L2) is larger, so it is
+    still an upper bound when it is computed with rounding.
+
+    orient2d and incircle, used by the Delaunay triangulation (delaunay.hpp), are filtered in the same way with the
+    error bounds of Shewchuk and computed exactly with expansion sums and products when the filter fails.
+*/
+
+#ifndef PREDICATES_HPP
+#define PREDICATES_HPP
+
+#include <cmath>
+#include <algorithm>
+
+namespace predicates {
+
+const double EPSILON = 1.1102230246251565e-16; //u = 2^-53, half of the machine epsilon
+const double LENGTH_ERROR_BOUND = (6.0 + 16.0*EPSILON)*EPSILON;
+const double ORIENT_ERROR_BOUND = (3.0 + 16.0*EPSILON)*EPSILON;
+const double INCIRCLE_ERROR_BOUND = (10.0 + 96.0*EPSILON)*EPSILON;
+
+//x + y = a + b exactly, x = fl(a + b)
+inline void two_sum(double a, double b, double &x, double &y){
+    x = a + b;
+    double b_virtual = x - a;
+    double a_virtual = x - b_virtual;
+    y = (a - a_virtual) + (b - b_virtual);
+}
+
+//x + y = a - b exactly, x = fl(a - b)
+inline void two_diff(double a, double b, double &x, double &y){
+    two_sum(a, -b, x, y);
+}
+
+//x + y = a * b exactly, x = fl(a * b)
+inline void two_product(double a, double b, double &x, double &y){
+    x = a*b;
+    y = std::fma(a, b, -x);
+}
+
+//Add b to the expansion e of length n, h can be e, the zero components are removed
+//Output: length of h, the components are in increasing order of magnitude and do not overlap
+inline int grow_expansion(int n, const double *e, double b, double *h){
+    int length = 0;
+    double q = b, hh;
+    for(int i = 0; i < n; i++){
+        two_sum(q, e[i], q, hh);
+        if(hh != 0.0)
+            h[length++] = hh;
+    }
+    if(q != 0.0 || length == 0)
+        h[length++] = q;
+    return length;
+}
+
+//x + y = a + b exactly, |a| >= |b|
+inline void fast_two_sum(double a, double b, double &x, double &y){
+    x = a + b;
+    y = b - (x - a);
+}
+
+//h = e + f, the zero components are removed
+//Output: length of h, at most elen + flen
+inline int expansion_sum(int elen, const double *e, int flen, const double *f, double *h){
+    int i = 0, j = 0, length = 0;
+    double q, hh;
+    //the components are added from the smallest magnitude
+    auto smallest = [&](){ return j == flen || (i < elen && (f[j] > e[i]) == (f[j] > -e[i])) ? e[i++] : f[j++]; };
+    q = smallest();
+    while(i < elen || j < flen){
+        two_sum(q, smallest(), q, hh);
+        if(hh != 0.0)
+            h[length++] = hh;
+    }
+    if(q != 0.0 || length == 0)
+        h[length++] = q;
+    return length;
+}
+
+//h = e * b, the zero components are removed
+//Output: length of h, at most 2 elen
+inline int scale_expansion(int elen, const double *e, double b, double *h){
+    int length = 0;
+    double q, hh, product1, product0, sum;
+    two_product(e[0], b, q, hh);
+    if(hh != 0.0)
+        h[length++] = hh;
+    for(int i = 1; i < elen; i++){
+        two_product(e[i], b, product1, product0);
+        two_sum(q, product0, sum, hh);
+        if(hh != 0.0)
+            h[length++] = hh;
+        fast_two_sum(product1, sum, q, hh);
+        if(hh != 0.0)
+            h[length++] = hh;
+    }
+    if(q != 0.0 || length == 0)
+        h[length++] = q;
+    return length;
+}
+
+//h = e * f, h must have space for 2 elen flen components and buffer for as many
+//Output: length of h
+inline int multiply_expansions(int elen, const double *e, int flen, const double *f, double *h, double *buffer){
+    double scaled[2*64];
+    int length = scale_expansion(elen, e, f[0], h);
+    for(int j = 1; j < flen; j++){
+        int n = scale_expansion(elen, e, f[j], scaled);
+        std::copy(h, h + length, buffer);
+        length = expansion_sum(length, buffer, n, scaled, h);
+    }
+    return length;
+}
+
+//a - b as an expansion of one or two components
+//Output: length of h
+inline int difference_expansion(double a, double b, double *h){
+    double x, y;
+    two_diff(a, b, x, y);
+    if(y == 0.0){
+        h[0] = x;
+        return 1;
+    }
+    h[0] = y;
+    h[1] = x;
+    return 2;
+}
+
+//Sign of the expansion e, its largest component is the last one
+inline int expansion_sign(int n, const double *e){
+    return (e[n-1] > 0) - (e[n-1] < 0);
+}
+
+//Sign of (ax - cx)(by - cy) - (ay - cy)(bx - cx) computed exactly
+inline int orient2d_exact(double ax, double ay, double bx, double by, double cx, double cy){
+    double acx[2], bcy[2], acy[2], bcx[2], left[8], right[8], det[16], buffer[8];
+    int n_acx = difference_expansion(ax, cx, acx), n_bcy = difference_expansion(by, cy, bcy);
+    int n_acy = difference_expansion(ay, cy, acy), n_bcx = difference_expansion(bx, cx, bcx);
+    int n_left = multiply_expansions(n_acx, acx, n_bcy, bcy, left, buffer);
+    int n_right = multiply_expansions(n_acy, acy, n_bcx, bcx, right, buffer);
+    for(int i = 0; i < n_right; i++)
+        right[i] = -right[i];
+    return expansion_sign(expansion_sum(n_left, left, n_right, right, det), det);
+}
+
+//Orientation of the points a, b, c: 1 if they are counterclockwise, -1 if they are clockwise and 0 if they are collinear
+inline int orient2d(double ax, double ay, double bx, double by, double cx, double cy){
+    double left = (ax - cx)*(by - cy);
+    double right = (ay - cy)*(bx - cx);
+    double det = left - right;
+    double sum;
+    if(left > 0){
+        if(right <= 0)
+            return (det > 0) - (det < 0);
+        sum = left + right;
+    }else if(left < 0){
+        if(right >= 0)
+            return (det > 0) - (det < 0);
+        sum = -left - right;
+    }else
+        return (det > 0) - (det < 0);
+    double bound = ORIENT_ERROR_BOUND*sum;
+    if(det > bound)
+        return 1;
+    if(det < -bound)
+        return -1;
+    return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+
+//Sign of lift(a) * (b x c) for the differences a, b, c of the points to d, lift(a) = adx^2 + ady^2
+//Output: length of h, at most 512 components
+inline int incircle_term(int n_adx, const double *adx, int n_ady, const double *ady, int n_bdx, const double *bdx,
+    int n_bdy, const double *bdy, int n_cdx, const double *cdx, int n_cdy, const double *cdy, double *h){
+    double xx[8], yy[8], lift[16], bc[8], cb[8], cross[16], buffer[512];
+    int n_xx = multiply_expansions(n_adx, adx, n_adx, adx, xx, buffer);
+    int n_yy = multiply_expansions(n_ady, ady, n_ady, ady, yy, buffer);
+    int n_lift = expansion_sum(n_xx, xx, n_yy, yy, lift);
+    int n_bc = multiply_expansions(n_bdx, bdx, n_cdy, cdy, bc, buffer);
+    int n_cb = multiply_expansions(n_cdx, cdx, n_bdy, bdy, cb, buffer);
+    for(int i = 0; i < n_cb; i++)
+        cb[i] = -cb[i];
+    int n_cross = expansion_sum(n_bc, bc, n_cb, cb, cross);
+    return multiply_expansions(n_lift, lift, n_cross, cross, h, buffer);
+}
+
+//Sign of the incircle determinant computed exactly
+inline int incircle_exact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy){
+    double adx[2], ady[2], bdx[2], bdy[2], cdx[2], cdy[2];
+    int n_adx = difference_expansion(ax, dx, adx), n_ady = difference_expansion(ay, dy, ady);
+    int n_bdx = difference_expansion(bx, dx, bdx), n_bdy = difference_expansion(by, dy, bdy);
+    int n_cdx = difference_expansion(cx, dx, cdx), n_cdy = difference_expansion(cy, dy, cdy);
+    double a[512], b[512], c[512], ab[1024], det[1536];
+    int n_a = incircle_term(n_adx, adx, n_ady, ady, n_bdx, bdx, n_bdy, bdy, n_cdx, cdx, n_cdy, cdy, a);
+    int n_b = incircle_term(n_bdx, bdx, n_bdy, bdy, n_cdx, cdx, n_cdy, cdy, n_adx, adx, n_ady, ady, b);
+    int n_c = incircle_term(n_cdx, cdx, n_cdy, cdy, n_adx, adx, n_ady, ady, n_bdx, bdx, n_bdy, bdy, c);
+    int n_ab = expansion_sum(n_a, a, n_b, b, ab);
+    return expansion_sign(expansion_sum(n_ab, ab, n_c, c, det), det);
+}
+
+//Position of d with respect to the circle through the counterclockwise points a, b, c:
+//1 if d is inside, -1 if it is outside and 0 if it is on the circle
+inline int incircle(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy){
+    double adx = ax - dx, bdx = bx - dx, cdx = cx - dx;
+    double ady = ay - dy, bdy = by - dy, cdy = cy - dy;
+    double bdxcdy = bdx*cdy, cdxbdy = cdx*bdy;
+    double alift = adx*adx + ady*ady;
+    double cdxady = cdx*ady, adxcdy = adx*cdy;
+    double blift = bdx*bdx + bdy*bdy;
+    double adxbdy = adx*bdy, bdxady = bdx*ady;
+    double clift = cdx*cdx + cdy*cdy;
+    double det = alift*(bdxcdy - cdxbdy) + blift*(cdxady - adxcdy) + clift*(adxbdy - bdxady);
+    double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy))*alift + (std::fabs(cdxady) + std::fabs(adxcdy))*blift
+        + (std::fabs(adxbdy) + std::fabs(bdxady))*clift;
+    double bound = INCIRCLE_ERROR_BOUND*permanent;
+    if(det > bound)
+        return 1;
+    if(det < -bound)
+        return -1;
+    return incircle_exact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+//Add sign * (x + y)^2 to the expansion e of length n, x + y is a coordinate difference without rounding
+//Output: new length of e
+inline int add_square(int n, double *e, double x, double y, double sign){
+    double p, q;
+    two_product(x, x, p, q);
+    n = grow_expansion(n, e, sign*p, e);
+    n = grow_expansion(n, e, sign*q, e);
+    two_product(2*x, y, p, q);
+    n = grow_expansion(n, e, sign*p, e);
+    n = grow_expansion(n, e, sign*q, e);
+    two_product(y, y, p, q);
+    n = grow_expansion(n, e, sign*p, e);
+    n = grow_expansion(n, e, sign*q, e);
+    return n;
+}
+
+//Sign of |ab|^2 - |cd|^2 computed exactly with expansions
+inline int compare_lengths_exact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy){
+    double e[25];
+    int n = 0;
+    double x, y;
+    two_diff(ax, bx, x, y);
+    n = add_square(n, e, x, y, 1.0);
+    two_diff(ay, by, x, y);
+    n = add_square(n, e, x, y, 1.0);
+    two_diff(cx, dx, x, y);
+    n = add_square(n, e, x, y, -1.0);
+    two_diff(cy, dy, x, y);
+    n = add_square(n, e, x, y, -1.0);
+    //the largest component has the sign of the sum
+    double top = e[n-1];
+    return (top > 0) - (top < 0);
+}
+
+//Sign of |ab|^2 - |cd|^2: 1 if ab is longer, -1 if cd is longer and 0 if they have the same length
+inline int compare_lengths(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy){
+    double abx = ax - bx, aby = ay - by, cdx = cx - dx, cdy = cy - dy;
+    double ab = abx*abx + aby*aby;
+    double cd = cdx*cdx + cdy*cdy;
+    double difference = ab - cd;
+    double bound = LENGTH_ERROR_BOUND*(ab + cd);
+    if(difference > bound)
+        return 1;
+    if(difference < -bound)
+        return -1;
+    return compare_lengths_exact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+//Index in [0, 3) of the longest edge of the triangle p0 p1 p2, the edge k goes from pk to p(k+1)%3
+//With ties, the same edge of the comparison of the lengths in PolyllaMesh::label_max_edge is returned:
+//0 if it is the longest, else 1 if it is the longest, else 2
+inline int longest_edge(double x0, double y0, double x1, double y1, double x2, double y2){
+    int c01 = compare_lengths(x0, y0, x1, y1, x1, y1, x2, y2); //edge 0 against edge 1
+    int c12 = compare_lengths(x1, y1, x2, y2, x2, y2, x0, y0); //edge 1 against edge 2
+    int c20 = compare_lengths(x2, y2, x0, y0, x0, y0, x1, y1); //edge 2 against edge 0
+    if(c01 >= 0 && c20 <= 0)
+        return 0;
+    if(c12 >= 0)
+        return 1;
+    return 2;
+}
+
+}
+
+#endif
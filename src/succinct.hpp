@@ -0,0 +1,157 @@
+/* Succinct data structures used by the compressed triangulation
+    packed_array: array of unsigned integers of a fixed number of bits
+    rank_select_bitvector: bit vector with rank and select in O(1) and O(log n)
+        rank1(i): number of ones in the positions [0, i)
+        rank0(i): number of zeros in the positions [0, i)
+        select1(k): position of the k-th one, starting from 0
+*/
+
+#ifndef SUCCINCT_HPP
+#define SUCCINCT_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+//Return the number of bits needed to store the values [0, n)
+inline int bits_for(uint64_t n){
+    if(n <= 2)
+        return 1;
+    return 64 - __builtin_clzll(n - 1);
+}
+
+//Array of n unsigned integers of width bits each, stored contiguously in 64-bit words
+class packed_array
+{
+private:
+    std::vector<uint64_t> words;
+    std::size_t n = 0;
+    int width = 1;
+    uint64_t mask = 1;
+
+public:
+    packed_array() {}
+
+    packed_array(std::size_t size, int bits) : n(size), width(bits) {
+        mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+        words.assign((n*width + 63)/64 + 1, 0);
+    }
+
+    std::size_t size() const { return n; }
+    int bits() const { return width; }
+    std::size_t bytes() const { return words.size()*sizeof(uint64_t); }
+
+    uint64_t get(std::size_t i) const {
+        std::size_t p = i*width;
+        std::size_t w = p >> 6;
+        int off = p & 63;
+        uint64_t value = words[w] >> off;
+        if(off + width > 64)
+            value |= words[w+1] << (64 - off);
+        return value & mask;
+    }
+
+    //The value must fit in the width of the array, the callers check their input before packing it
+    void set(std::size_t i, uint64_t value){
+        assert(i < n && (value & ~mask) == 0);
+        std::size_t p = i*width;
+        std::size_t w = p >> 6;
+        int off = p & 63;
+        value &= mask;
+        words[w] = (words[w] & ~(mask << off)) | (value << off);
+        if(off + width > 64){
+            int done = 64 - off;
+            words[w+1] = (words[w+1] & ~(mask >> done)) | (value >> done);
+        }
+    }
+};
+
+//Bit vector with rank and select
+//The number of ones before each block of 512 bits is stored, so rank is a lookup plus at most 8 popcounts
+//and select is a binary search over the blocks
+class rank_select_bitvector
+{
+private:
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> block_rank; //number of ones before each block of 8 words
+    std::size_t n = 0;
+    std::size_t ones = 0;
+
+public:
+    rank_select_bitvector() {}
+
+    rank_select_bitvector(std::size_t size) : n(size) {
+        words.assign((n + 63)/64 + 1, 0);
+    }
+
+    std::size_t size() const { return n; }
+    std::size_t count() const { return ones; }
+    std::size_t bytes() const { return (words.size() + block_rank.size())*sizeof(uint64_t); }
+
+    bool get(std::size_t i) const {
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(std::size_t i, bool value){
+        assert(i < n);
+        if(value)
+            words[i >> 6] |= 1ULL << (i & 63);
+        else
+            words[i >> 6] &= ~(1ULL << (i & 63));
+    }
+
+    //Calculate the rank of the blocks, it must be called after the bits are set
+    void build(){
+        std::size_t n_blocks = (words.size() + 7)/8;
+        block_rank.assign(n_blocks + 1, 0);
+        uint64_t count = 0;
+        for(std::size_t w = 0; w < words.size(); w++){
+            if(w % 8 == 0)
+                block_rank[w/8] = count;
+            count += __builtin_popcountll(words[w]);
+        }
+        block_rank[n_blocks] = count;
+        ones = count;
+    }
+
+    std::size_t rank1(std::size_t i) const {
+        std::size_t w = i >> 6;
+        std::size_t r = block_rank[w >> 3];
+        for(std::size_t k = w & ~7ULL; k < w; k++)
+            r += __builtin_popcountll(words[k]);
+        if(i & 63)
+            r += __builtin_popcountll(words[w] & ((1ULL << (i & 63)) - 1));
+        return r;
+    }
+
+    std::size_t rank0(std::size_t i) const {
+        return i - rank1(i);
+    }
+
+    std::size_t select1(std::size_t k) const {
+        //last block with less than k+1 ones before it
+        std::size_t lo = 0, hi = (words.size() + 7)/8;
+        while(hi - lo > 1){
+            std::size_t mid = (lo + hi)/2;
+            if(block_rank[mid] <= k)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        k -= block_rank[lo];
+        std::size_t w = lo*8;
+        while(true){
+            std::size_t c = __builtin_popcountll(words[w]);
+            if(k < c)
+                break;
+            k -= c;
+            w++;
+        }
+        uint64_t word = words[w];
+        for(std::size_t j = 0; j < k; j++)
+            word &= word - 1;
+        return w*64 + __builtin_ctzll(word);
+    }
+};
+
+#endif
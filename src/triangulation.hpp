@@ -22,15 +22,18 @@ Others
     halfEdges(): Return number of halfedges
     vertices(): Return number of vertices
     get_Triangles(): bitvector of triangles where true if the halfege generate a unique face, false if the face is generated by another halfedge
+    edge_of_face(f): return a halfedge of the face f
     get_PointX(int i): return the i-th x coordinate of the triangulation
     get_PointY(int i): return the i-th y coordinate of the triangulation
+    get_point_arrays(): pointers to the coordinates of the vertices, for max_edge_kernel.hpp
+    set_Point(int i, double x, double y): move the i-th vertex to (x, y)
+    memory_usage(): bytes used by the vertices, halfedges and triangles
 
 TODO:
     edge_iterator;
     face_iterator;
     vertex_iterator;
     copy constructor;
-    constructor indepent of triangle
 */
 
 #ifndef TRIANGULATION_HPP
@@ -41,9 +44,14 @@ TODO:
 #include <iostream>
 #include <fstream>
 #include <cmath>
-#include <sstream>
-#include <unordered_map>
-#include <map>
+#include <memory>
+#include <stdexcept>
+#include <mesh_reader.hpp>
+#include <mesh_array.hpp>
+#include <mesh_binary.hpp>
+#include <instrumentation.hpp>
+#include <twin_matching.hpp>
+#include <max_edge_kernel.hpp>
 
 struct vertex{
     double x;
@@ -64,111 +72,92 @@ struct halfEdge {
     int is_border; //1 if the halfedge is on the boundary, 0 otherwise
 };
 
+//Check the triangles of a triangulation of n_vertices vertices
+//Input: number of vertices, three vertices of each triangle, neighbors of each triangle or empty
+//Throw std::invalid_argument if the arrays have wrong sizes or a triangle has a vertex or a neighbor out of range
+inline void require_mesh_arrays(std::size_t n_vertices, mesh_span<const int> triangles, mesh_span<const int> neighs){
+    if(triangles.size() % 3 != 0 || (!neighs.empty() && neighs.size() != triangles.size()))
+        throw std::invalid_argument("the mesh needs 3 vertices and 3 neighbors per triangle");
+    for(std::size_t e = 0; e < triangles.size(); e++){
+        if(triangles[e] < 0 || (std::size_t)triangles[e] >= n_vertices)
+            throw std::invalid_argument("the triangle " + std::to_string(e/3) + " has the vertex " + std::to_string(triangles[e]) + " out of range");
+        if(!neighs.empty() && (neighs[e] < -1 || (std::size_t)(neighs[e] + 1) > triangles.size()/3))
+            throw std::invalid_argument("the triangle " + std::to_string(e/3) + " has the neighbor " + std::to_string(neighs[e]) + " out of range");
+    }
+}
+
+//Twin of the halfedge v0 v1 of the triangle t in its neighbor n, the halfedge v1 v0 of n
+//Input: vertices of each triangle, as an array or a compact triangulation with the origin of each halfedge
+//Throw std::invalid_argument if the neighbor does not have the edge, the .neigh file does not match the .ele file
+template <typename Faces>
+int twin_in_neighbor(const Faces &faces, std::size_t t, int n, int v0, int v1){
+    for(std::size_t j = 0; j < 3; j++)
+        if(faces.at(3*n + j) == v1 && faces.at(3*n + (j + 1)%3) == v0)
+            return 3*n + j;
+    throw std::invalid_argument("the neighbor " + std::to_string(n) + " of the triangle " + std::to_string(t) + " does not share the edge " + std::to_string(v0) + " " + std::to_string(v1));
+}
+
+//Check the arrays of a triangulation given in memory
+//Input: x and y of each vertex, three vertices of each triangle, neighbors of each triangle or empty
+//Throw std::invalid_argument as the check of the triangles, or if x and y have different sizes
+inline void require_mesh_arrays(mesh_span<const double> x, mesh_span<const double> y, mesh_span<const int> triangles, mesh_span<const int> neighs){
+    if(x.size() != y.size())
+        throw std::invalid_argument("the mesh needs one x and y per vertex");
+    require_mesh_arrays(x.size(), triangles, neighs);
+}
+
 class Triangulation 
 {
 
-private:
+protected: //the construction steps are protected so they can be measured separately by the benchmarks
 
     typedef std::array<int,3> _triangle; 
     int n_halfedges = 0; //number of halfedges
     int n_faces = 0; //number of faces
     int n_vertices = 0; //number of vertices
-    std::vector<vertex> Vertices;
-    std::vector<halfEdge> HalfEdges; //list of edges
+    mesh_array<vertex> Vertices;
+    mesh_array<halfEdge> HalfEdges; //list of edges
     //std::vector<char> triangle_flags; //list of edges that generate a unique triangles, 
-    std::vector<int> triangle_list; //list of edges that generate a unique triangles, 
-    typedef std::pair<int,int> _edge;
+    mesh_array<int> triangle_list; //list of edges that generate a unique triangles, 
+    std::shared_ptr<mesh_binary::file> binary_file; //binary file whose arrays are used in place, if any
 
     //Read node file in .node format and nodes in point vector
-    void read_nodes_from_file(std::string name){
-        std::string line;
-        std::ifstream nodefile(name);
-        double a1, a2, a3, a4;
-        
-        //std::cout<<"Node file"<<std::endl;
-        if (nodefile.is_open())
-        {
-            nodefile >> n_vertices;
-            //std::cout<<pnumber<<std::endl;
-            Vertices.reserve(n_vertices);
-            std::getline(nodefile, line); //skip the first line
-            while (std::getline(nodefile, line))
-            {
-                std::istringstream(line) >> a1 >> a2 >> a3 >> a4;
-                vertex ve;
-                ve.x =  a2;
-                ve.y =  a3;
-                ve.is_border = (a4 == 1) ? true : false;
-                Vertices.push_back(ve);
-            }  
+    void read_nodes_from_file(std::string name, int n_threads){
+        std::vector<double> points;
+        std::vector<char> border;
+        if(mesh_reader::read_node_file(name, points, border, n_threads) < 0)
+            throw std::runtime_error("unable to read the node file " + name);
+        n_vertices = border.size();
+        Vertices.resize(n_vertices);
+        for(std::size_t i = 0; i < n_vertices; i++){
+            Vertices[i].x = points[2*i+0];
+            Vertices[i].y = points[2*i+1];
+            Vertices[i].is_border = border[i];
         }
-        else 
-            std::cout << "Unable to open node file"; 
-        nodefile.close();
     }
 
     //Read triangle file in .ele format and stores it in faces vector
-    std::vector<int> read_triangles_from_file(std::string name){
+    std::vector<int> read_triangles_from_file(std::string name, int n_threads){
         std::vector<int> faces;
-        std::string line;
-        std::ifstream elefile(name);
-        int a1, a2, a3, a4;
-        
-        //std::cout<<"Node file"<<std::endl;
-        if (elefile.is_open())
-        {
-            elefile >> n_faces;
-            //std::cout<<pnumber<<std::endl;
-            faces.reserve(3*n_faces);
-            std::getline(elefile, line); //skip the first line
-            while (std::getline(elefile, line))
-            {
-                std::istringstream(line) >> a1 >> a2 >> a3 >> a4;
-                faces.push_back(a2);
-                faces.push_back(a3);
-                faces.push_back(a4);
-                //std::cout<<"Vertex "<<a1<<" "<<v.x<<" "<<v.y<<" "<<v.is_border<<std::endl;
-            }
-        }
-        else 
-            std::cout << "Unable to open node file"; 
-        elefile.close();
-
+        if(!mesh_reader::read_ele_file(name, faces, n_threads))
+            throw std::runtime_error("unable to read the ele file " + name);
+        n_faces = faces.size()/3;
         return faces;
     }
 
     //Read node file in .node format and nodes in point vector
-    std::vector<int>  read_neigh_from_file(std::string name){
+    std::vector<int>  read_neigh_from_file(std::string name, int n_threads){
         std::vector<int> neighs;
-        std::string line;
-        std::ifstream neighfile(name);
-        int a1, a2, a3, a4;
-        
-        //std::cout<<"Node file"<<std::endl;
-        if (neighfile.is_open())
-        {
-            neighfile >> n_faces;
-            //std::cout<<pnumber<<std::endl;
-            neighs.reserve(3*n_faces);
-            std::getline(neighfile, line); //skip the first line
-            while (std::getline(neighfile, line))
-            {
-                std::istringstream(line) >> a1 >> a2 >> a3 >> a4;
-                neighs.push_back(a2);
-                neighs.push_back(a3);
-                neighs.push_back(a4);
-                
-            }
-        }
-        else 
-            std::cout << "Unable to open node file"; 
-        neighfile.close();
+        if(!mesh_reader::read_neigh_file(name, neighs, n_threads))
+            throw std::runtime_error("unable to read the neigh file " + name);
+        n_faces = neighs.size()/3;
         return neighs;
     }
 
     //Generate interior halfedges using faces and neigh vectors
     //also associate each vertex with an incident halfedge
-    void construct_interior_halfEdges_from_faces_and_neighs(std::vector<int> faces, std::vector<int> neighs){
+    //Throw std::invalid_argument if a neighbor does not share the edge
+    void construct_interior_halfEdges_from_faces_and_neighs(mesh_span<const int> faces, mesh_span<const int> neighs){
         for(std::size_t i = 0; i < n_faces; i++){
             halfEdge he0, he1, he2;
             int index_he0 = i*3+0;
@@ -188,15 +177,9 @@ private:
             he0.face = i;
             he0.is_border = (n2 == -1);
             Vertices.at(v0).incident_halfedge = index_he0;
-            if(n2 != -1){
-                for (std::size_t j = 0; j < 3; j++)
-                {
-                    if(faces.at(3*n2 + j) == v1 && faces.at(3*n2 + (j + 1)%3) == v0){
-                        he0.twin = 3*n2 + j;
-                        break;
-                    }
-                }
-            }else
+            if(n2 != -1)
+                he0.twin = twin_in_neighbor(faces, i, n2, v0, v1);
+            else
                 he0.twin = -1;
 
             HalfEdges.push_back(he0);
@@ -211,15 +194,9 @@ private:
             Vertices.at(v1).incident_halfedge = index_he1;
             
 
-            if(n0 != -1){
-                for (std::size_t j = 0; j < 3; j++)
-                {
-                    if(faces.at(3*n0 + j) == v2 && faces.at(3*n0 + (j + 1)%3) == v1){
-                        he1.twin = 3*n0 + j;
-                        break;
-                    }
-                }
-            }else
+            if(n0 != -1)
+                he1.twin = twin_in_neighbor(faces, i, n0, v1, v2);
+            else
                 he1.twin = -1;
             HalfEdges.push_back(he1);
 
@@ -232,13 +209,7 @@ private:
             Vertices.at(v2).incident_halfedge = index_he2;
 
             if(n1 != -1)
-                for (std::size_t j = 0; j < 3; j++)
-                {
-                    if(faces.at(3*n1 + j) == v0 && faces.at(3*n1 + (j + 1)%3) == v2){
-                        he2.twin = 3*n1 + j;
-                        break;
-                    }
-                }
+                he2.twin = twin_in_neighbor(faces, i, n1, v2, v0);
             else
                 he2.twin = -1;
             
@@ -250,8 +221,9 @@ private:
 
     //Generate exterior halfedges
     //Literally calculates the convex hull
-    //this takes O(n + k*k), with n the number of interior halfedges and k the number of exterior halfedges
-    //optimize to a version n + k
+    //The next and prev exterior halfedges are linked using the exterior halfedge that leaves each vertex,
+    //this takes O(n + k), with n the number of interior halfedges and k the number of exterior halfedges
+    //Each boundary loop (outer boundary and holes) is linked independently
     void construct_exterior_halfEdges(){
         //search interior edges labed as border, generates exterior edges
         //with the origin and target inverted and add at the of HalfEdges vector
@@ -267,24 +239,21 @@ private:
                 HalfEdges.at(i).twin = HalfEdges.size() - 1 ;
             }    
                
-        
-        //traverse the exterior edges and search their next prev halfedge
-        int v_origin, v_target;
+        //exterior halfedge with vertex v as origin, if a vertex has more than one
+        //the first exterior halfedge is used
+        std::vector<int> exterior_edge_of_vertex(this->n_vertices, -1);
         for(std::size_t i = n_halfedges; i < HalfEdges.size(); i++){
-            if(HalfEdges.at(i).is_border){
-                //search prev of the halfedge
-                for(std::size_t j = n_halfedges; j < HalfEdges.size(); j++)
-                    if(HalfEdges.at(j).origin == HalfEdges.at(i).target){
-                        HalfEdges.at(j).prev = i;
-                        break;
-                    }
-                //search next of each exterior edge   
-                for(std::size_t j = n_halfedges; j < HalfEdges.size(); j++)
-                    if(HalfEdges.at(i).target == HalfEdges.at(j).origin){
-                            HalfEdges.at(i).next = j;
-                            break;
-                    }
-            }
+            int v = HalfEdges.at(i).origin;
+            if(exterior_edge_of_vertex.at(v) == -1)
+                exterior_edge_of_vertex.at(v) = i;
+        }
+
+        //the next of each exterior edge is the exterior edge that leaves its target
+        int nxt;
+        for(std::size_t i = n_halfedges; i < HalfEdges.size(); i++){
+            nxt = exterior_edge_of_vertex.at(HalfEdges.at(i).target);
+            HalfEdges.at(i).next = nxt;
+            HalfEdges.at(nxt).prev = i;
         }
 
         this->n_halfedges = HalfEdges.size();
@@ -294,153 +263,46 @@ private:
     //Generate interior halfedges using a a vector with the faces of the triangulation
     //if an interior half-edge is border, it is mark as border-edge
     //mark border-edges
-    void construct_interior_halfEdges_from_faces(std::vector<int> faces){
-        auto hash_for_pair = [](const std::pair<int, int>& p) {
-            return std::hash<int>{}(p.first) ^ std::hash<int>{}(p.second);
-        };
-        std::unordered_map<_edge, int, decltype(hash_for_pair)> map_edges(3*this->n_faces, hash_for_pair); //set of edges to calculate the boundary and twin edges
-        for(std::size_t i = 0; i < n_faces; i++){
-            halfEdge he0, he1, he2;
-            int index_he0 = i*3+0;
-            int index_he1 = i*3+1;
-            int index_he2 = i*3+2;
-            int v0 = faces.at(3*i+0);
-            int v1 = faces.at(3*i+1);
-            int v2 = faces.at(3*i+2);
-            
-            he0.origin = v0;
-            he0.target = v1;
-            he0.next = index_he1;
-            he0.prev = index_he2;
-            he0.face = i;
-            he0.is_border = false;
-            he0.twin = -1;
-            //falta twin
-            Vertices.at(v0).incident_halfedge = index_he0;
-            
-            map_edges[std::make_pair(v0, v1)] = index_he0;
-            HalfEdges.push_back(he0);
-            
-            he1.origin = v1;
-            he1.target = v2;
-            he1.next = index_he2;
-            he1.prev = index_he0;
-            he1.face = i;
-            he1.is_border = false;
-            he1.twin = -1;
-            Vertices.at(v1).incident_halfedge = index_he1;
-            
-            map_edges[std::make_pair(v1, v2)] = index_he1;
-            HalfEdges.push_back(he1);
-
-            he2.origin = v2;
-            he2.target = v0;
-            he2.next = index_he0;
-            he2.prev = index_he1;
-            he2.face = i;
-            he2.is_border = false;
-            he2.twin = -1;
-            Vertices.at(v2).incident_halfedge = index_he2;
-
-            map_edges[std::make_pair(v2, v0)] = index_he2;            
-            HalfEdges.push_back(he2);
-        }
-        this->n_halfedges = HalfEdges.size();
-
-        //Calculate twin halfedge and boundary halfedges from set_edges
-        std::unordered_map<_edge,int, decltype(hash_for_pair)>::iterator it;
-        for(std::size_t i = 0; i < HalfEdges.size(); i++){
-            //if halfedge has no twin
-            if(HalfEdges.at(i).twin == -1){
-                _edge twin = std::make_pair(HalfEdges.at(i).target,HalfEdges.at(i).origin);
-                it=map_edges.find(twin);
-                //if twin is found
-                if(it!=map_edges.end()){
-                    int index_twin = it->second;
-                    HalfEdges.at(i).twin = index_twin;
-                    HalfEdges.at(index_twin).twin = i;
-                }else{ //if twin is not found and halfedge is on the boundary
-                    HalfEdges.at(i).is_border = true;
-                    Vertices.at(HalfEdges.at(i).origin).is_border = true;
-                    Vertices.at(HalfEdges.at(i).target).is_border = true;
-                }
+    //The twins are matched sorting the edges (twin_matching.hpp), duplicate and non-manifold edges are reported
+    void construct_interior_halfEdges_from_faces(mesh_span<const int> faces, int n_threads = 1){
+        twin_matching matching = match_twins(faces, n_vertices, n_threads);
+        const std::vector<int> &twins = matching.twins;
+        require_manifold(matching);
+        instrumentation::get().count("boundary_edges", matching.n_boundary_edges);
+        HalfEdges.resize(3*n_faces);
+        for(std::size_t e = 0; e < 3*n_faces; e++){
+            halfEdge he;
+            he.origin = faces.at(e);
+            he.target = faces.at(3*(e/3) + (e+1)%3);
+            he.next = 3*(e/3) + (e+1)%3;
+            he.prev = 3*(e/3) + (e+2)%3;
+            he.face = e/3;
+            he.twin = twins[e];
+            he.is_border = twins[e] == -1;
+            Vertices.at(he.origin).incident_halfedge = e;
+            if(he.is_border){
+                Vertices.at(he.origin).is_border = true;
+                Vertices.at(he.target).is_border = true;
             }
+            HalfEdges[e] = he;
         }
+        this->n_halfedges = HalfEdges.size();
     }
 
     //Read the mesh from a file in OFF format
-    std::vector<int> read_OFFfile(std::string name){
+    std::vector<int> read_OFFfile(std::string name, int n_threads){
         //Read the OFF file
         std::vector<int> faces;
-		std::string line;
-		std::ifstream offfile(name);
-		double a1, a2, a3;
-		std::string tmp;
-		if (offfile.is_open())
-		{
-            //Check first line is a OFF file
-			while (std::getline(offfile, line)){ //add check boundary vertices flag
-				std::istringstream(line) >> tmp;
-				if (tmp[0] != '#' ) //check if first element is a comentary
-				{
-					if(tmp[0] == 'O' && tmp[1] == 'F' && tmp[2] == 'F') //Check if the format is OFF
-                        break;
-                    else{
-                        std::cout<<"The file is not an OFF file"<<std::endl;
-                        exit(0);
-                    }
-				}
-			}
-
-            //Read the number of vertices and faces
-            
-            while (std::getline(offfile, line)){ //add check boundary vertices flag
-				std::istringstream(line) >> tmp;
-				if (tmp[0] != '#' ) //check if first element is a comentary
-				{
-						std::istringstream(line) >> this->n_vertices >> this->n_faces;
-			            this->Vertices.reserve(this->n_vertices);
-                        faces.reserve(3*this->n_faces);
-						break;
-				}
-			}
-
-            //Read vertices
-            int index = 0;
-			while (index < n_vertices && std::getline(offfile, line) )
-			{
-				std::istringstream(line) >> tmp;
-				if (tmp[0] != '#' ) //check if first element is a comentary
-				{
-					std::istringstream(line) >> a1 >> a2 >> a3;
-					vertex ve;
-                    ve.x =  a1;
-                    ve.y =  a2;
-                    this->Vertices.push_back(ve);
-                    index++;
-				}
-			}
-            //Read faces
-            
-            int lenght, t1, t2, t3;
-            index = 0;
-			while (index < n_faces && std::getline(offfile, line) )
-			{
-				std::istringstream(line) >> tmp;
-				if (tmp[0] != '#' ) //check if first element is a comentary
-				{
-                    std::istringstream(line) >> lenght >> t1 >> t2 >> t3;
-                    faces.push_back(t1);
-                    faces.push_back(t2);
-                    faces.push_back(t3);
-                    index++;
-				}
-			}
-
-		}
-		else 
-				std::cout << "Unable to open node file"; 
-		offfile.close();
+        std::vector<double> points;
+        if(!mesh_reader::read_off_file(name, points, faces, n_threads))
+            throw std::runtime_error("unable to read the OFF file " + name);
+        this->n_vertices = points.size()/2;
+        this->n_faces = faces.size()/3;
+        this->Vertices.resize(this->n_vertices);
+        for(std::size_t i = 0; i < n_vertices; i++){
+            this->Vertices[i].x = points[2*i+0];
+            this->Vertices[i].y = points[2*i+1];
+        }
         return faces;
     }
 
@@ -451,20 +313,33 @@ public:
     Triangulation() {}
 
     //Constructor from file
-    Triangulation(std::string node_file, std::string ele_file, std::string neigh_file) {
+    //The files are parsed with n_threads threads
+    Triangulation(std::string node_file, std::string ele_file, std::string neigh_file, int n_threads = 1) {
         std::vector<int> faces;
         std::vector<int> neighs;
+        instrumentation &stats = instrumentation::get();
         std::cout<<"Reading node file"<<std::endl;
-        read_nodes_from_file(node_file);
+        stats.begin("read_node_file");
+        read_nodes_from_file(node_file, n_threads);
+        stats.end();
         //fusionar estos dos métodos
         std::cout<<"Reading ele file"<<std::endl;
-        faces = read_triangles_from_file(ele_file);
+        stats.begin("read_ele_file");
+        faces = read_triangles_from_file(ele_file, n_threads);
+        stats.end();
         std::cout<<"Reading neigh file"<<std::endl;
-        neighs = read_neigh_from_file(neigh_file);
+        stats.begin("read_neigh_file");
+        neighs = read_neigh_from_file(neigh_file, n_threads);
+        stats.end();
         //std::cout<<"Constructing interior halfedges"<<std::endl;
+        stats.begin("interior_halfedges");
         construct_interior_halfEdges_from_faces_and_neighs(faces, neighs);
+        stats.end();
         //std::cout<<"Constructing exterior halfedges"<<std::endl;
+        stats.begin("exterior_halfedges");
         construct_exterior_halfEdges();
+        stats.count("exterior_halfedges", n_halfedges - 3*n_faces);
+        stats.end();
         //std::cout<<"Constructing triangles"<<std::endl;
 
         triangle_list.reserve(n_faces);
@@ -473,17 +348,122 @@ public:
 
     }
 
-    Triangulation(std::string OFF_file){
+    //Constructor from arrays, used for the triangulation of a part of a larger mesh
+    //Input: x, y and boundary marker of each vertex, vertices and neighbors of each triangle as in the .ele and .neigh files
+    Triangulation(const std::vector<double> &points, const std::vector<char> &border, const std::vector<int> &faces, const std::vector<int> &neighs){
+        n_vertices = border.size();
+        n_faces = faces.size()/3;
+        Vertices.resize(n_vertices);
+        for(std::size_t i = 0; i < n_vertices; i++){
+            Vertices[i].x = points[2*i+0];
+            Vertices[i].y = points[2*i+1];
+            Vertices[i].is_border = border[i];
+        }
+        construct_interior_halfEdges_from_faces_and_neighs(faces, neighs);
+        construct_exterior_halfEdges();
+        triangle_list.reserve(n_faces);
+        for(std::size_t i = 0; i < n_faces; i++)
+            triangle_list.push_back(3*i);
+    }
+
+    //Constructor from arrays in memory, the vertices and triangles are copied to the vertex and halfEdge structs
+    //Input: x and y of each vertex, three vertices of each triangle counterclockwise, neighbors of each triangle
+    //       as in the .neigh file or empty, then the twins are matched as in a OFF file
+    //The vertices of the edges without neighbor are the boundary
+    //Throw std::invalid_argument if the arrays are not a valid triangulation
+    Triangulation(mesh_span<const double> x, mesh_span<const double> y, mesh_span<const int> triangles, mesh_span<const int> neighs = {}, int n_threads = 1){
+        require_mesh_arrays(x, y, triangles, neighs);
+        n_vertices = x.size();
+        n_faces = triangles.size()/3;
+        Vertices.resize(n_vertices);
+        for(std::size_t i = 0; i < n_vertices; i++){
+            Vertices[i].x = x[i];
+            Vertices[i].y = y[i];
+        }
+        if(neighs.empty())
+            construct_interior_halfEdges_from_faces(triangles, n_threads);
+        else{
+            construct_interior_halfEdges_from_faces_and_neighs(triangles, neighs);
+            for(std::size_t e = 0; e < n_halfedges; e++){
+                if(HalfEdges[e].is_border){
+                    Vertices[HalfEdges[e].origin].is_border = true;
+                    Vertices[HalfEdges[e].target].is_border = true;
+                }
+            }
+        }
+        construct_exterior_halfEdges();
+        triangle_list.reserve(n_faces);
+        for(std::size_t i = 0; i < n_faces; i++)
+            triangle_list.push_back(3*i);
+    }
+
+    Triangulation(std::string OFF_file, int n_threads = 1){
+        instrumentation &stats = instrumentation::get();
         std::cout<<"Reading OFF file "<<OFF_file<<std::endl;
-        std::vector<int> faces = read_OFFfile(OFF_file);
-        construct_interior_halfEdges_from_faces(faces);
+        stats.begin("read_off_file");
+        std::vector<int> faces = read_OFFfile(OFF_file, n_threads);
+        stats.end();
+        stats.begin("interior_halfedges");
+        construct_interior_halfEdges_from_faces(faces, n_threads);
+        stats.end();
+        stats.begin("exterior_halfedges");
         construct_exterior_halfEdges();
+        stats.count("exterior_halfedges", n_halfedges - 3*n_faces);
+        stats.end();
 
         triangle_list.reserve(n_faces);
         for(std::size_t i = 0; i < n_faces; i++)
             triangle_list.push_back(3*i);
     }
 
+    //Constructor from a binary mesh file, the arrays of the file are used in place without copying them
+    //and the halfedges are not linked again
+    //Throw std::runtime_error if the file does not have the arrays of the triangulation or their sizes are not
+    //the counts of its header
+    Triangulation(std::shared_ptr<mesh_binary::file> file){
+        const mesh_binary::header &h = file->get_header();
+        if(h.vertex_size != sizeof(vertex) || h.halfedge_size != sizeof(halfEdge))
+            throw std::runtime_error("the binary file was written with a different halfedge structure");
+        std::size_t n_v, n_he, n_t;
+        vertex *v = file->get<vertex>(mesh_binary::VERTICES, n_v);
+        halfEdge *he = file->get<halfEdge>(mesh_binary::HALFEDGES, n_he);
+        int *t = file->get<int>(mesh_binary::TRIANGLES, n_t);
+        if(v == nullptr || he == nullptr || t == nullptr)
+            throw std::runtime_error("the binary file does not have the vertices, halfedges and triangles of a triangulation");
+        if(n_v != (std::size_t)h.n_vertices || n_he != (std::size_t)h.n_halfedges || n_t != (std::size_t)h.n_faces)
+            throw std::runtime_error("the arrays of the binary file do not have the sizes of its header");
+        this->binary_file = file;
+        this->Vertices.view(v, n_v);
+        this->HalfEdges.view(he, n_he);
+        this->triangle_list.view(t, n_t);
+        this->n_vertices = h.n_vertices;
+        this->n_faces = h.n_faces;
+        this->n_halfedges = h.n_halfedges;
+    }
+
+    //Return the number of bytes used by the triangulation
+    std::size_t memory_usage(){
+        return Vertices.size()*sizeof(vertex) + HalfEdges.size()*sizeof(halfEdge) + triangle_list.size()*sizeof(int);
+    }
+
+    //Add the arrays of the triangulation to a binary mesh file
+    void add_to_binary(mesh_binary::writer &out){
+        mesh_binary::header &h = out.get_header();
+        h.n_vertices = n_vertices;
+        h.n_faces = n_faces;
+        h.n_halfedges = n_halfedges;
+        out.add_section(mesh_binary::VERTICES, Vertices.data(), Vertices.size()*sizeof(vertex));
+        out.add_section(mesh_binary::HALFEDGES, HalfEdges.data(), HalfEdges.size()*sizeof(halfEdge));
+        out.add_section(mesh_binary::TRIANGLES, triangle_list.data(), triangle_list.size()*sizeof(int));
+    }
+
+    //Write the triangulation in a binary mesh file, return false if the file could not be written
+    bool print_binary(std::string file_name){
+        mesh_binary::writer out(sizeof(vertex), sizeof(halfEdge));
+        add_to_binary(out);
+        return out.write(file_name);
+    }
+
     //print the triangulation in pg file format
     void print_pg(std::string file_name){
         std::ofstream file;
@@ -608,10 +588,15 @@ public:
 
     //list of triangles where true if the halfege generate a unique face, false if the face is generated by another halfedge
     //Replace by a triangle iterator
-    std::vector<int> get_Triangles(){
+    const mesh_array<int> &get_Triangles(){
         return triangle_list;
     }
 
+    //Return a halfedge of the face f
+    int edge_of_face(int f){
+        return triangle_list.at(f);
+    }
+
     double get_PointX(int i){
         return Vertices.at(i).x;
     }
@@ -620,6 +605,24 @@ public:
         return Vertices.at(i).y;
     }
 
+    //Coordinates of the vertices, the x and y fields of Vertices
+    max_edge_kernel::point_arrays get_point_arrays(){
+        static_assert(sizeof(vertex) % sizeof(double) == 0, "the stride of the coordinates must be whole doubles");
+        max_edge_kernel::point_arrays p;
+        if(n_vertices > 0){
+            p.x = &Vertices[0].x;
+            p.y = &Vertices[0].y;
+        }
+        p.stride = sizeof(vertex)/sizeof(double);
+        return p;
+    }
+
+    //Move the vertex i to (x, y), the halfedges are not changed
+    void set_Point(int i, double x, double y){
+        Vertices.at(i).x = x;
+        Vertices.at(i).y = y;
+    }
+
     //Calculates the next edge of the face incident to edge e
     //Input: e is the edge
     //Output: the next edge of the face incident to e
@@ -695,4 +698,37 @@ public:
 
 };
 
+//Add a triangulation with the accessors of Triangulation to a binary mesh file
+//The halfedges are expanded to the vertex and halfEdge structs, used by the triangulations that do not store them
+template <typename Mesh>
+void add_expanded_to_binary(Mesh &tr, mesh_binary::writer &out){
+    std::vector<vertex> vertices(tr.vertices());
+    for(std::size_t v = 0; v < vertices.size(); v++){
+        vertices[v].x = tr.get_PointX(v);
+        vertices[v].y = tr.get_PointY(v);
+        vertices[v].is_border = tr.is_border_vertex(v);
+        vertices[v].incident_halfedge = tr.edge_of_vertex(v);
+    }
+    std::vector<halfEdge> halfedges(tr.halfEdges());
+    for(std::size_t e = 0; e < halfedges.size(); e++){
+        halfedges[e].origin = tr.origin(e);
+        halfedges[e].target = tr.target(e);
+        halfedges[e].twin = tr.twin(e);
+        halfedges[e].next = tr.next(e);
+        halfedges[e].prev = tr.prev(e);
+        halfedges[e].face = tr.face_index(e);
+        halfedges[e].is_border = tr.is_border_face(e);
+    }
+    std::vector<int> triangles(tr.faces());
+    for(std::size_t t = 0; t < triangles.size(); t++)
+        triangles[t] = tr.edge_of_face(t);
+    mesh_binary::header &h = out.get_header();
+    h.n_vertices = tr.vertices();
+    h.n_faces = tr.faces();
+    h.n_halfedges = tr.halfEdges();
+    out.add_section(mesh_binary::VERTICES, std::move(vertices));
+    out.add_section(mesh_binary::HALFEDGES, std::move(halfedges));
+    out.add_section(mesh_binary::TRIANGLES, std::move(triangles));
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+/* Twin matching of the halfedges of a list of triangles
+    The halfedge 3t+i goes from faces[3t+i] to faces[3t+(i+1)%3]. Each halfedge is packed in a 64-bit key
+    (min vertex, max vertex) and the keys are sorted with a parallel LSD radix sort, so the halfedges of the
+    same edge are consecutive and the twins are found in a linear scan, without a hash table.
+    Radix sort is stable, so the halfedges of an edge are sorted by index and the result does not depend on
+    the number of threads.
+
+    Each edge is classified by its halfedges:
+        one halfedge: boundary edge, the halfedge has no twin
+        two halfedges in opposite directions: interior edge, they are twins
+        two halfedges in the same direction: duplicate edge (repeated triangle or inconsistent orientation)
+        more than two halfedges: non-manifold edge
+    The halfedges of duplicate and non-manifold edges are left without twin, they can not be represented
+    with halfedges, so require_manifold throws std::invalid_argument if there is any.
+*/
+
+#ifndef TWIN_MATCHING_HPP
+#define TWIN_MATCHING_HPP
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <parallel.hpp>
+
+struct twin_matching {
+    std::vector<int> twins; //twin of each halfedge, -1 if it has no twin
+    std::size_t n_boundary_edges = 0;
+    std::size_t n_duplicate_edges = 0;
+    std::size_t n_non_manifold_edges = 0;
+};
+
+//Sort keys and values by the key_bits lowest bits of the keys, 8 bits per pass
+//Each thread counts the digits of its block, the blocks are scattered in order so the sort is stable
+inline void radix_sort(std::vector<uint64_t> &keys, std::vector<int> &values, int key_bits, int n_threads){
+    const int radix_bits = 8;
+    const std::size_t buckets = 1 << radix_bits;
+    std::size_t n = keys.size();
+    std::vector<uint64_t> keys_tmp(n);
+    std::vector<int> values_tmp(n);
+    std::vector<std::size_t> count(n_threads*buckets);
+    for(int shift = 0; shift < key_bits; shift += radix_bits){
+        std::fill(count.begin(), count.end(), 0);
+        parallel_for_blocks(0, n, n_threads, [&](int id, std::size_t begin, std::size_t end){
+            std::size_t *c = &count[id*buckets];
+            for(std::size_t i = begin; i < end; i++)
+                c[(keys[i] >> shift) & (buckets - 1)]++;
+        });
+        //position of the first key of each digit of each thread, digits in order and threads in order
+        std::size_t sum = 0;
+        for(std::size_t d = 0; d < buckets; d++){
+            for(int t = 0; t < n_threads; t++){
+                std::size_t c = count[t*buckets + d];
+                count[t*buckets + d] = sum;
+                sum += c;
+            }
+        }
+        parallel_for_blocks(0, n, n_threads, [&](int id, std::size_t begin, std::size_t end){
+            std::size_t *c = &count[id*buckets];
+            for(std::size_t i = begin; i < end; i++){
+                std::size_t p = c[(keys[i] >> shift) & (buckets - 1)]++;
+                keys_tmp[p] = keys[i];
+                values_tmp[p] = values[i];
+            }
+        });
+        keys.swap(keys_tmp);
+        values.swap(values_tmp);
+    }
+}
+
+//Calculate the twin of each halfedge of the triangles
+//Input: faces with three vertices per triangle (a std::vector, mesh_array or mesh_span), number of vertices,
+//       number of threads
+//Output: twin of each halfedge and the number of boundary, duplicate and non-manifold edges
+template <typename Faces>
+inline twin_matching match_twins(const Faces &faces, std::size_t n_vertices, int n_threads = 1){
+    std::size_t n = faces.size();
+    int vertex_bits = 1;
+    while(((uint64_t)1 << vertex_bits) < n_vertices)
+        vertex_bits++;
+    std::vector<uint64_t> keys(n);
+    std::vector<int> order(n);
+    parallel_for_blocks(0, n, n_threads, [&](int, std::size_t begin, std::size_t end){
+        for(std::size_t e = begin; e < end; e++){
+            uint64_t a = faces[e], b = faces[3*(e/3) + (e+1)%3];
+            keys[e] = (std::min(a, b) << vertex_bits) | std::max(a, b);
+            order[e] = e;
+        }
+    });
+    radix_sort(keys, order, 2*vertex_bits, n_threads);
+
+    twin_matching result;
+    result.twins.assign(n, -1);
+    std::vector<std::size_t> boundary(n_threads, 0), duplicate(n_threads, 0), non_manifold(n_threads, 0);
+    //each thread classifies the edges that start in its block
+    parallel_for_blocks(0, n, n_threads, [&](int id, std::size_t begin, std::size_t end){
+        std::size_t i = begin;
+        while(i < end && i > 0 && keys[i] == keys[i-1])
+            i++;
+        while(i < end){
+            std::size_t j = i + 1;
+            while(j < n && keys[j] == keys[i])
+                j++;
+            if(j - i == 1){
+                boundary[id]++;
+            }else if(j - i == 2){
+                int a = order[i], b = order[i+1];
+                if(faces[a] != faces[b]){
+                    result.twins[a] = b;
+                    result.twins[b] = a;
+                }else
+                    duplicate[id]++;
+            }else
+                non_manifold[id]++;
+            i = j;
+        }
+    });
+    for(int t = 0; t < n_threads; t++){
+        result.n_boundary_edges += boundary[t];
+        result.n_duplicate_edges += duplicate[t];
+        result.n_non_manifold_edges += non_manifold[t];
+    }
+    return result;
+}
+
+//Throw std::invalid_argument if the triangles have duplicate or non-manifold edges
+inline void require_manifold(const twin_matching &matching){
+    if(matching.n_duplicate_edges == 0 && matching.n_non_manifold_edges == 0)
+        return;
+    throw std::invalid_argument("the triangulation has " + std::to_string(matching.n_duplicate_edges) + " duplicate edges and "
+        + std::to_string(matching.n_non_manifold_edges) + " non-manifold edges");
+}
+
+#endif